@@ -0,0 +1,216 @@
+#include "AlakazamBitrateController.h"
+
+namespace
+{
+	// How often quality and resolution are reconsidered
+	constexpr double EvaluationInterval = 0.5;
+
+	// The minimum round trip is forgotten after this long, so a changed route is picked up
+	constexpr double MinRttWindow = 30.0;
+
+	// Round trip above the minimum tolerated before calling it congestion
+	constexpr double RttToleranceSeconds = 0.05;
+	constexpr double RttToleranceFraction = 0.5;
+
+	// Round trip growth between two evaluations that means a queue is building
+	constexpr double RttRiseTolerance = 0.02;
+
+	// Time to let a queue drain after stepping down before judging again
+	constexpr double BackoffHoldSeconds = 1.0;
+
+	// Time without congestion before stepping quality, and then resolution, back up
+	constexpr double QualityProbeSeconds = 2.0;
+	constexpr double ResolutionProbeSeconds = 5.0;
+
+	constexpr int32 QualityStepDown = 10;
+	constexpr int32 QualityStepUp = 5;
+
+	// Delivered bitrate below this share of the sent bitrate means frames are piling up or being dropped
+	constexpr float RateDeficitFraction = 0.7f;
+
+	constexpr float RttSmoothing = 0.2f;
+	constexpr float RateSmoothing = 0.3f;
+
+	// Unanswered frames remembered for matching replies
+	constexpr int32 MaxPendingFrames = 64;
+}
+
+void FAlakazamBitrateController::SetQualityRange(int32 InMaxQuality, int32 InMinQuality)
+{
+	MaxQuality = FMath::Clamp(InMaxQuality, 1, 100);
+	MinQuality = FMath::Clamp(InMinQuality, 1, MaxQuality);
+	Quality = FMath::Clamp(Quality, MinQuality, MaxQuality);
+}
+
+void FAlakazamBitrateController::Reset()
+{
+	Quality = MaxQuality;
+	Rung = 0;
+
+	Pending.Reset();
+	SmoothedRtt = 0.0;
+	MinRtt = 0.0;
+	MinRttTime = 0.0;
+	LastEvaluation = 0.0;
+	LastEvaluationRtt = 0.0;
+	LastChange = 0.0;
+	LastCongestion = 0.0;
+	bWrittenOff = false;
+	DeliveredBytes = 0;
+	DeliveredKbps = 0.0f;
+	SentBytes = 0;
+	SentKbps = 0.0f;
+}
+
+FIntPoint FAlakazamBitrateController::GetRungSize(int32 InRung, int32 FullWidth, int32 FullHeight)
+{
+	const float Scale = LadderScales[FMath::Clamp(InRung, 0, NumRungs - 1)];
+	const int32 Width = FMath::Max(64, FMath::RoundToInt(FullWidth * Scale) & ~7);
+	const int32 Height = FMath::Max(64, FMath::RoundToInt(FullHeight * Scale) & ~7);
+	return FIntPoint(Width, Height);
+}
+
+void FAlakazamBitrateController::OnFrameSent(double SendTime, int64 Bytes, uint32 Sequence)
+{
+	if (Pending.Num() >= MaxPendingFrames)
+	{
+		Pending.RemoveAt(0);
+	}
+
+	FPendingFrame Frame;
+	Frame.SendTime = SendTime;
+	Frame.Bytes = Bytes;
+	Frame.Sequence = Sequence;
+	Pending.Add(Frame);
+	SentBytes += Bytes;
+}
+
+void FAlakazamBitrateController::OnFrameAnswered(double Now)
+{
+	if (Pending.Num() > 0)
+	{
+		AnswerPendingFrame(0, Now);
+	}
+}
+
+void FAlakazamBitrateController::OnFrameAnswered(double Now, uint32 Sequence)
+{
+	// Not found: a reply overtaken by a newer one, or a frame already written off
+	const int32 Index = Pending.IndexOfByPredicate([Sequence](const FPendingFrame& Frame) { return Frame.Sequence == Sequence; });
+	if (Index != INDEX_NONE)
+	{
+		AnswerPendingFrame(Index, Now);
+	}
+}
+
+void FAlakazamBitrateController::AnswerPendingFrame(int32 Index, double Now)
+{
+	// Frames sent before this one were skipped by the server; they are not delivered
+	const FPendingFrame Frame = Pending[Index];
+	Pending.RemoveAt(0, Index + 1);
+	DeliveredBytes += Frame.Bytes;
+
+	const double Rtt = FMath::Max(0.0, Now - Frame.SendTime);
+	SmoothedRtt = SmoothedRtt == 0.0 ? Rtt : FMath::Lerp(SmoothedRtt, Rtt, static_cast<double>(RttSmoothing));
+	if (MinRtt == 0.0 || Rtt < MinRtt || Now - MinRttTime > MinRttWindow)
+	{
+		MinRtt = Rtt;
+		MinRttTime = Now;
+	}
+}
+
+void FAlakazamBitrateController::OnFramesWrittenOff()
+{
+	Pending.Reset();
+	bWrittenOff = true;
+}
+
+bool FAlakazamBitrateController::IsCongested(double Now) const
+{
+	if (bWrittenOff)
+	{
+		return true;
+	}
+	if (MinRtt == 0.0)
+	{
+		return false;
+	}
+
+	const double Threshold = MinRtt + FMath::Max(RttToleranceSeconds, MinRtt * RttToleranceFraction);
+	const double OldestWait = Pending.Num() > 0 ? Now - Pending[0].SendTime : 0.0;
+	const bool bRising = LastEvaluationRtt > 0.0 && SmoothedRtt - LastEvaluationRtt > RttRiseTolerance;
+	const bool bRateDeficit = SentKbps > 0.0f && DeliveredKbps < SentKbps * RateDeficitFraction;
+	return SmoothedRtt > Threshold || OldestWait > Threshold * 2.0 || bRising || bRateDeficit;
+}
+
+bool FAlakazamBitrateController::Update(double Now)
+{
+	if (LastEvaluation == 0.0)
+	{
+		LastEvaluation = Now;
+		LastChange = Now;
+		LastCongestion = Now;
+		return false;
+	}
+
+	const double Elapsed = Now - LastEvaluation;
+	if (Elapsed < EvaluationInterval)
+	{
+		return false;
+	}
+
+	const float Kbps = static_cast<float>(DeliveredBytes * 8 / 1000.0 / Elapsed);
+	DeliveredKbps = DeliveredKbps == 0.0f ? Kbps : FMath::Lerp(DeliveredKbps, Kbps, RateSmoothing);
+	DeliveredBytes = 0;
+
+	const float SentRate = static_cast<float>(SentBytes * 8 / 1000.0 / Elapsed);
+	SentKbps = SentKbps == 0.0f ? SentRate : FMath::Lerp(SentKbps, SentRate, RateSmoothing);
+	SentBytes = 0;
+	LastEvaluation = Now;
+
+	const int32 OldQuality = Quality;
+	const int32 OldRung = Rung;
+	const bool bCongested = IsCongested(Now);
+	LastEvaluationRtt = SmoothedRtt;
+
+	if (bCongested)
+	{
+		LastCongestion = Now;
+		bWrittenOff = false;
+
+		// Back off once, then give the queue time to drain before reacting again
+		if (Now - LastChange >= BackoffHoldSeconds)
+		{
+			if (Quality > MinQuality)
+			{
+				Quality = FMath::Max(MinQuality, Quality - QualityStepDown);
+			}
+			else if (Rung < NumRungs - 1)
+			{
+				// Fewer pixels free up bytes for a better quality at the new size
+				Rung++;
+				Quality = (MinQuality + MaxQuality) / 2;
+			}
+		}
+	}
+	else if (Quality < MaxQuality)
+	{
+		if (Now - FMath::Max(LastCongestion, LastChange) >= QualityProbeSeconds)
+		{
+			Quality = FMath::Min(MaxQuality, Quality + QualityStepUp);
+		}
+	}
+	else if (Rung > 0 && Now - FMath::Max(LastCongestion, LastChange) >= ResolutionProbeSeconds)
+	{
+		// More pixels at a lower quality, so the probe does not jump straight to the full bitrate
+		Rung--;
+		Quality = (MinQuality + MaxQuality) / 2;
+	}
+
+	if (Quality != OldQuality || Rung != OldRung)
+	{
+		LastChange = Now;
+		return true;
+	}
+	return false;
+}
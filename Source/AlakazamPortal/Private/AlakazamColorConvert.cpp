@@ -0,0 +1,634 @@
+#include "AlakazamColorConvert.h"
+#include "AlakazamSimd.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+void FAlakazamPlanarImage::Allocate(EAlakazamPixelLayout InLayout, int32 InWidth, int32 InHeight)
+{
+	Layout = InLayout;
+	Width = InWidth;
+	Height = InHeight;
+
+	const int32 HalfWidth = (InWidth + 1) / 2;
+	const int32 HalfHeight = (InHeight + 1) / 2;
+
+	switch (InLayout)
+	{
+	case EAlakazamPixelLayout::Luma:
+		NumPlanes = 1;
+		PlaneWidth[0] = InWidth; PlaneHeight[0] = InHeight;
+		break;
+	case EAlakazamPixelLayout::RGB24:
+		NumPlanes = 1;
+		PlaneWidth[0] = InWidth * 3; PlaneHeight[0] = InHeight;
+		break;
+	case EAlakazamPixelLayout::YUV444:
+		NumPlanes = 3;
+		PlaneWidth[0] = PlaneWidth[1] = PlaneWidth[2] = InWidth;
+		PlaneHeight[0] = PlaneHeight[1] = PlaneHeight[2] = InHeight;
+		break;
+	case EAlakazamPixelLayout::YUV422:
+		NumPlanes = 3;
+		PlaneWidth[0] = InWidth; PlaneHeight[0] = InHeight;
+		PlaneWidth[1] = PlaneWidth[2] = HalfWidth;
+		PlaneHeight[1] = PlaneHeight[2] = InHeight;
+		break;
+	case EAlakazamPixelLayout::YUV420:
+		NumPlanes = 3;
+		PlaneWidth[0] = InWidth; PlaneHeight[0] = InHeight;
+		PlaneWidth[1] = PlaneWidth[2] = HalfWidth;
+		PlaneHeight[1] = PlaneHeight[2] = HalfHeight;
+		break;
+	case EAlakazamPixelLayout::NV12:
+		NumPlanes = 2;
+		PlaneWidth[0] = InWidth; PlaneHeight[0] = InHeight;
+		PlaneWidth[1] = HalfWidth * 2; PlaneHeight[1] = HalfHeight;
+		break;
+	}
+
+	for (int32 Plane = 0; Plane < 3; Plane++)
+	{
+		if (Plane < NumPlanes)
+		{
+			Planes[Plane].SetNumUninitialized(static_cast<int64>(PlaneWidth[Plane]) * PlaneHeight[Plane]);
+		}
+		else
+		{
+			PlaneWidth[Plane] = PlaneHeight[Plane] = 0;
+			Planes[Plane].Reset();
+		}
+	}
+}
+
+namespace
+{
+	// Widest kernels the row dispatch may use; lowered only by tests and benchmarks
+	std::atomic<EAlakazamKernelSet> MaxKernelSet{ EAlakazamKernelSet::NEON };
+
+	FORCEINLINE bool UseKernels(EAlakazamKernelSet KernelSet)
+	{
+		return MaxKernelSet.load(std::memory_order_relaxed) >= KernelSet;
+	}
+
+	// Full-range BT.601 coefficients in 2.14 fixed point
+	constexpr int32 CoefShift = 14;
+	constexpr int32 YR = 4899, YG = 9617, YB = 1868;
+	constexpr int32 UR = -2765, UG = -5427, UB = 8192;
+	constexpr int32 VR = 8192, VG = -6860, VB = -1332;
+
+	/** Weights in source channel order (channel 3, alpha, is ignored) */
+	struct FWeights
+	{
+		int16 C0, C1, C2;
+	};
+
+	template<EAlakazamSourceFormat SourceFormat>
+	struct TFormatWeights
+	{
+		static constexpr FWeights Y = { YB, YG, YR };
+		static constexpr FWeights U = { UB, UG, UR };
+		static constexpr FWeights V = { VB, VG, VR };
+		static constexpr int32 RedChannel = 2;
+	};
+
+	template<>
+	struct TFormatWeights<EAlakazamSourceFormat::RGBA>
+	{
+		static constexpr FWeights Y = { YR, YG, YB };
+		static constexpr FWeights U = { UR, UG, UB };
+		static constexpr FWeights V = { VR, VG, VB };
+		static constexpr int32 RedChannel = 0;
+	};
+
+	// Rounding for luma; chroma uses 0.5-epsilon so a full-scale value cannot round up to 256
+	constexpr int32 LumaBias(int32 Shift) { return 1 << (Shift - 1); }
+	constexpr int32 ChromaBias(int32 Shift) { return (128 << Shift) + (1 << (Shift - 1)) - 1; }
+
+	FORCEINLINE uint8 WeightedPixel(const uint8* Pixel, const FWeights& W, int32 Bias, int32 Shift)
+	{
+		return static_cast<uint8>((W.C0 * Pixel[0] + W.C1 * Pixel[1] + W.C2 * Pixel[2] + Bias) >> Shift);
+	}
+
+	// ---------------------------------------------------------------------
+	// Scalar row kernels, also used for the tails of the SIMD kernels
+	// ---------------------------------------------------------------------
+
+	void RowWeighted_Scalar(const uint8* Src, uint8* Dst, int32 Start, int32 Width, const FWeights& W, int32 Bias)
+	{
+		for (int32 X = Start; X < Width; X++)
+		{
+			Dst[X] = WeightedPixel(Src + X * 4, W, Bias, CoefShift);
+		}
+	}
+
+	/** Chroma of 2x2 blocks. UVStep is 1 for planar output and 2 for interleaved (NV12) output. */
+	void RowChroma420_Scalar(const uint8* Src0, const uint8* Src1, uint8* DstU, uint8* DstV, int32 UVStep,
+		int32 Start, int32 Width, const FWeights& WU, const FWeights& WV)
+	{
+		constexpr int32 Shift = CoefShift + 2;
+		for (int32 X = Start; X < Width; X += 2)
+		{
+			const int32 X1 = FMath::Min(X + 1, Width - 1);
+			int32 Sum[3];
+			for (int32 Channel = 0; Channel < 3; Channel++)
+			{
+				Sum[Channel] = Src0[X * 4 + Channel] + Src0[X1 * 4 + Channel] + Src1[X * 4 + Channel] + Src1[X1 * 4 + Channel];
+			}
+			const int32 Out = (X / 2) * UVStep;
+			DstU[Out] = static_cast<uint8>((WU.C0 * Sum[0] + WU.C1 * Sum[1] + WU.C2 * Sum[2] + ChromaBias(Shift)) >> Shift);
+			DstV[Out] = static_cast<uint8>((WV.C0 * Sum[0] + WV.C1 * Sum[1] + WV.C2 * Sum[2] + ChromaBias(Shift)) >> Shift);
+		}
+	}
+
+	void RowRGB24_Scalar(const uint8* Src, uint8* Dst, int32 Start, int32 Width, int32 RedChannel)
+	{
+		const int32 BlueChannel = 2 - RedChannel;
+		for (int32 X = Start; X < Width; X++)
+		{
+			Dst[X * 3 + 0] = Src[X * 4 + RedChannel];
+			Dst[X * 3 + 1] = Src[X * 4 + 1];
+			Dst[X * 3 + 2] = Src[X * 4 + BlueChannel];
+		}
+	}
+
+	// ---------------------------------------------------------------------
+	// SSE2 / SSSE3 / AVX2. Each kernel returns how many pixels it converted.
+	// ---------------------------------------------------------------------
+
+#if ALAKAZAM_SIMD_SSE
+	FORCEINLINE __m128i LoadWeights(const FWeights& W)
+	{
+		return _mm_setr_epi16(W.C0, W.C1, W.C2, 0, W.C0, W.C1, W.C2, 0);
+	}
+
+	/** Adds adjacent int32 pairs: [a0+a1, a2+a3, b0+b1, b2+b3] */
+	FORCEINLINE __m128i HorizontalPairSum(__m128i A, __m128i B)
+	{
+		const __m128 Even = _mm_shuffle_ps(_mm_castsi128_ps(A), _mm_castsi128_ps(B), _MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 Odd = _mm_shuffle_ps(_mm_castsi128_ps(A), _mm_castsi128_ps(B), _MM_SHUFFLE(3, 1, 3, 1));
+		return _mm_add_epi32(_mm_castps_si128(Even), _mm_castps_si128(Odd));
+	}
+
+	/** Weighted channel sums of four 16-bit-per-channel pixels held in two registers */
+	FORCEINLINE __m128i WeightedSum4(__m128i Lo, __m128i Hi, __m128i Weights)
+	{
+		return HorizontalPairSum(_mm_madd_epi16(Lo, Weights), _mm_madd_epi16(Hi, Weights));
+	}
+
+	int32 RowWeighted_SSE2(const uint8* Src, uint8* Dst, int32 Start, int32 Width, const FWeights& W, int32 Bias)
+	{
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Weights = LoadWeights(W);
+		const __m128i BiasVec = _mm_set1_epi32(Bias);
+
+		int32 X = Start;
+		for (; X + 16 <= Width; X += 16)
+		{
+			__m128i Sums[4];
+			for (int32 Block = 0; Block < 4; Block++)
+			{
+				const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + (X + Block * 4) * 4));
+				const __m128i Sum = WeightedSum4(_mm_unpacklo_epi8(Pixels, Zero), _mm_unpackhi_epi8(Pixels, Zero), Weights);
+				Sums[Block] = _mm_srai_epi32(_mm_add_epi32(Sum, BiasVec), CoefShift);
+			}
+			const __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(Sums[0], Sums[1]), _mm_packs_epi32(Sums[2], Sums[3]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + X), Packed);
+		}
+		return X;
+	}
+
+	int32 RowChroma420_SSE2(const uint8* Src0, const uint8* Src1, uint8* DstU, uint8* DstV, int32 UVStep,
+		int32 Start, int32 Width, const FWeights& WU, const FWeights& WV)
+	{
+		constexpr int32 Shift = CoefShift + 2;
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i WeightsU = LoadWeights(WU);
+		const __m128i WeightsV = LoadWeights(WV);
+		const __m128i BiasVec = _mm_set1_epi32(ChromaBias(Shift));
+
+		int32 X = Start;
+		for (; X + 8 <= Width; X += 8)
+		{
+			const __m128i A0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src0 + X * 4));
+			const __m128i B0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src0 + X * 4 + 16));
+			const __m128i A1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src1 + X * 4));
+			const __m128i B1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src1 + X * 4 + 16));
+
+			// Vertical sums, two pixels per register
+			const __m128i P01 = _mm_add_epi16(_mm_unpacklo_epi8(A0, Zero), _mm_unpacklo_epi8(A1, Zero));
+			const __m128i P23 = _mm_add_epi16(_mm_unpackhi_epi8(A0, Zero), _mm_unpackhi_epi8(A1, Zero));
+			const __m128i P45 = _mm_add_epi16(_mm_unpacklo_epi8(B0, Zero), _mm_unpacklo_epi8(B1, Zero));
+			const __m128i P67 = _mm_add_epi16(_mm_unpackhi_epi8(B0, Zero), _mm_unpackhi_epi8(B1, Zero));
+
+			// Horizontal pair sums give the 2x2 block totals, two blocks per register
+			const __m128i S01 = _mm_unpacklo_epi64(_mm_add_epi16(P01, _mm_srli_si128(P01, 8)), _mm_add_epi16(P23, _mm_srli_si128(P23, 8)));
+			const __m128i S23 = _mm_unpacklo_epi64(_mm_add_epi16(P45, _mm_srli_si128(P45, 8)), _mm_add_epi16(P67, _mm_srli_si128(P67, 8)));
+
+			const __m128i U = _mm_srai_epi32(_mm_add_epi32(WeightedSum4(S01, S23, WeightsU), BiasVec), Shift);
+			const __m128i V = _mm_srai_epi32(_mm_add_epi32(WeightedSum4(S01, S23, WeightsV), BiasVec), Shift);
+
+			// Bytes: u0 u1 u2 u3 v0 v1 v2 v3
+			const __m128i Bytes = _mm_packus_epi16(_mm_packs_epi32(U, V), Zero);
+			const int32 Out = (X / 2) * UVStep;
+			if (UVStep == 2)
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(DstU + Out), _mm_unpacklo_epi8(Bytes, _mm_srli_si128(Bytes, 4)));
+			}
+			else
+			{
+				const int32 UBytes = _mm_cvtsi128_si32(Bytes);
+				const int32 VBytes = _mm_cvtsi128_si32(_mm_srli_si128(Bytes, 4));
+				FMemory::Memcpy(DstU + Out, &UBytes, 4);
+				FMemory::Memcpy(DstV + Out, &VBytes, 4);
+			}
+		}
+		return X;
+	}
+#endif // ALAKAZAM_SIMD_SSE
+
+#if ALAKAZAM_SIMD_SSSE3
+	int32 RowRGB24_SSSE3(const uint8* Src, uint8* Dst, int32 Start, int32 Width, int32 RedChannel)
+	{
+		const __m128i Shuffle = RedChannel == 2
+			? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+			: _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+		// Each store writes 16 bytes of which 12 are kept, so stop while 6+ pixels remain
+		int32 X = Start;
+		for (; X + 6 <= Width; X += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + X * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + X * 3), _mm_shuffle_epi8(Pixels, Shuffle));
+		}
+		return X;
+	}
+#endif // ALAKAZAM_SIMD_SSSE3
+
+#if ALAKAZAM_SIMD_AVX2
+	int32 RowWeighted_AVX2(const uint8* Src, uint8* Dst, int32 Start, int32 Width, const FWeights& W, int32 Bias)
+	{
+		const __m256i Zero = _mm256_setzero_si256();
+		const __m256i Weights = _mm256_setr_epi16(
+			W.C0, W.C1, W.C2, 0, W.C0, W.C1, W.C2, 0,
+			W.C0, W.C1, W.C2, 0, W.C0, W.C1, W.C2, 0);
+		const __m256i BiasVec = _mm256_set1_epi32(Bias);
+		// Packing works per 128-bit lane, this restores pixel order afterwards
+		const __m256i Order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+		int32 X = Start;
+		for (; X + 32 <= Width; X += 32)
+		{
+			__m256i Sums[4];
+			for (int32 Block = 0; Block < 4; Block++)
+			{
+				const __m256i Pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + (X + Block * 8) * 4));
+				const __m256i Lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(Pixels, Zero), Weights);
+				const __m256i Hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(Pixels, Zero), Weights);
+				Sums[Block] = _mm256_srai_epi32(_mm256_add_epi32(_mm256_hadd_epi32(Lo, Hi), BiasVec), CoefShift);
+			}
+			const __m256i Packed = _mm256_packus_epi16(_mm256_packs_epi32(Sums[0], Sums[1]), _mm256_packs_epi32(Sums[2], Sums[3]));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + X), _mm256_permutevar8x32_epi32(Packed, Order));
+		}
+		return X;
+	}
+#endif // ALAKAZAM_SIMD_AVX2
+
+	// ---------------------------------------------------------------------
+	// NEON
+	// ---------------------------------------------------------------------
+
+#if ALAKAZAM_SIMD_NEON
+	template<int32 Shift>
+	FORCEINLINE uint16x4_t WeightedSum4(int16x4_t C0, int16x4_t C1, int16x4_t C2, const FWeights& W, int32 Bias)
+	{
+		int32x4_t Acc = vdupq_n_s32(Bias);
+		Acc = vmlal_n_s16(Acc, C0, W.C0);
+		Acc = vmlal_n_s16(Acc, C1, W.C1);
+		Acc = vmlal_n_s16(Acc, C2, W.C2);
+		return vqmovun_s32(vshrq_n_s32(Acc, Shift));
+	}
+
+	template<int32 Shift>
+	FORCEINLINE uint8x8_t WeightedSum8(uint16x8_t C0, uint16x8_t C1, uint16x8_t C2, const FWeights& W, int32 Bias)
+	{
+		const int16x8_t S0 = vreinterpretq_s16_u16(C0);
+		const int16x8_t S1 = vreinterpretq_s16_u16(C1);
+		const int16x8_t S2 = vreinterpretq_s16_u16(C2);
+		const uint16x4_t Lo = WeightedSum4<Shift>(vget_low_s16(S0), vget_low_s16(S1), vget_low_s16(S2), W, Bias);
+		const uint16x4_t Hi = WeightedSum4<Shift>(vget_high_s16(S0), vget_high_s16(S1), vget_high_s16(S2), W, Bias);
+		return vqmovn_u16(vcombine_u16(Lo, Hi));
+	}
+
+	int32 RowWeighted_NEON(const uint8* Src, uint8* Dst, int32 Start, int32 Width, const FWeights& W, int32 Bias)
+	{
+		int32 X = Start;
+		for (; X + 16 <= Width; X += 16)
+		{
+			const uint8x16x4_t Pixels = vld4q_u8(Src + X * 4);
+			const uint8x8_t Lo = WeightedSum8<CoefShift>(
+				vmovl_u8(vget_low_u8(Pixels.val[0])), vmovl_u8(vget_low_u8(Pixels.val[1])), vmovl_u8(vget_low_u8(Pixels.val[2])), W, Bias);
+			const uint8x8_t Hi = WeightedSum8<CoefShift>(
+				vmovl_u8(vget_high_u8(Pixels.val[0])), vmovl_u8(vget_high_u8(Pixels.val[1])), vmovl_u8(vget_high_u8(Pixels.val[2])), W, Bias);
+			vst1q_u8(Dst + X, vcombine_u8(Lo, Hi));
+		}
+		return X;
+	}
+
+	int32 RowChroma420_NEON(const uint8* Src0, const uint8* Src1, uint8* DstU, uint8* DstV, int32 UVStep,
+		int32 Start, int32 Width, const FWeights& WU, const FWeights& WV)
+	{
+		constexpr int32 Shift = CoefShift + 2;
+		int32 X = Start;
+		for (; X + 16 <= Width; X += 16)
+		{
+			const uint8x16x4_t Row0 = vld4q_u8(Src0 + X * 4);
+			const uint8x16x4_t Row1 = vld4q_u8(Src1 + X * 4);
+
+			// Pairwise horizontal add of row 0, accumulate row 1: 2x2 block totals
+			const uint16x8_t S0 = vpadalq_u8(vpaddlq_u8(Row0.val[0]), Row1.val[0]);
+			const uint16x8_t S1 = vpadalq_u8(vpaddlq_u8(Row0.val[1]), Row1.val[1]);
+			const uint16x8_t S2 = vpadalq_u8(vpaddlq_u8(Row0.val[2]), Row1.val[2]);
+
+			const uint8x8_t U = WeightedSum8<Shift>(S0, S1, S2, WU, ChromaBias(Shift));
+			const uint8x8_t V = WeightedSum8<Shift>(S0, S1, S2, WV, ChromaBias(Shift));
+
+			const int32 Out = (X / 2) * UVStep;
+			if (UVStep == 2)
+			{
+				uint8x8x2_t Interleaved;
+				Interleaved.val[0] = U;
+				Interleaved.val[1] = V;
+				vst2_u8(DstU + Out, Interleaved);
+			}
+			else
+			{
+				vst1_u8(DstU + Out, U);
+				vst1_u8(DstV + Out, V);
+			}
+		}
+		return X;
+	}
+
+	int32 RowRGB24_NEON(const uint8* Src, uint8* Dst, int32 Start, int32 Width, int32 RedChannel)
+	{
+		int32 X = Start;
+		for (; X + 16 <= Width; X += 16)
+		{
+			const uint8x16x4_t Pixels = vld4q_u8(Src + X * 4);
+			uint8x16x3_t Rgb;
+			Rgb.val[0] = Pixels.val[RedChannel];
+			Rgb.val[1] = Pixels.val[1];
+			Rgb.val[2] = Pixels.val[2 - RedChannel];
+			vst3q_u8(Dst + X * 3, Rgb);
+		}
+		return X;
+	}
+#endif // ALAKAZAM_SIMD_NEON
+
+	// ---------------------------------------------------------------------
+	// Row dispatch: widest kernel first, narrower ones and scalar for the tail
+	// ---------------------------------------------------------------------
+
+	void RowWeighted(const uint8* Src, uint8* Dst, int32 Width, const FWeights& W, int32 Bias)
+	{
+		int32 X = 0;
+#if ALAKAZAM_SIMD_AVX2
+		if (UseKernels(EAlakazamKernelSet::AVX2))
+		{
+			X = RowWeighted_AVX2(Src, Dst, X, Width, W, Bias);
+		}
+#endif
+#if ALAKAZAM_SIMD_SSE
+		if (UseKernels(EAlakazamKernelSet::SSE2))
+		{
+			X = RowWeighted_SSE2(Src, Dst, X, Width, W, Bias);
+		}
+#endif
+#if ALAKAZAM_SIMD_NEON
+		if (UseKernels(EAlakazamKernelSet::NEON))
+		{
+			X = RowWeighted_NEON(Src, Dst, X, Width, W, Bias);
+		}
+#endif
+		RowWeighted_Scalar(Src, Dst, X, Width, W, Bias);
+	}
+
+	void RowChroma420(const uint8* Src0, const uint8* Src1, uint8* DstU, uint8* DstV, int32 UVStep,
+		int32 Width, const FWeights& WU, const FWeights& WV)
+	{
+		int32 X = 0;
+#if ALAKAZAM_SIMD_SSE
+		if (UseKernels(EAlakazamKernelSet::SSE2))
+		{
+			X = RowChroma420_SSE2(Src0, Src1, DstU, DstV, UVStep, X, Width, WU, WV);
+		}
+#endif
+#if ALAKAZAM_SIMD_NEON
+		if (UseKernels(EAlakazamKernelSet::NEON))
+		{
+			X = RowChroma420_NEON(Src0, Src1, DstU, DstV, UVStep, X, Width, WU, WV);
+		}
+#endif
+		RowChroma420_Scalar(Src0, Src1, DstU, DstV, UVStep, X, Width, WU, WV);
+	}
+
+	void RowRGB24(const uint8* Src, uint8* Dst, int32 Width, int32 RedChannel)
+	{
+		int32 X = 0;
+#if ALAKAZAM_SIMD_SSSE3
+		if (UseKernels(EAlakazamKernelSet::SSSE3))
+		{
+			X = RowRGB24_SSSE3(Src, Dst, X, Width, RedChannel);
+		}
+#endif
+#if ALAKAZAM_SIMD_NEON
+		if (UseKernels(EAlakazamKernelSet::NEON))
+		{
+			X = RowRGB24_NEON(Src, Dst, X, Width, RedChannel);
+		}
+#endif
+		RowRGB24_Scalar(Src, Dst, X, Width, RedChannel);
+	}
+}
+
+namespace AlakazamColorConvert
+{
+	template<EAlakazamSourceFormat SourceFormat, EAlakazamPixelLayout Layout>
+	void ConvertRows(const FAlakazamPixelView& Source, FAlakazamPlanarImage& Dest, int32 FirstRow, int32 NumRows)
+	{
+		using Weights = TFormatWeights<SourceFormat>;
+		constexpr int32 YBias = LumaBias(CoefShift);
+		constexpr int32 UVBias = ChromaBias(CoefShift);
+
+		const int32 Width = Source.Width;
+		const int32 EndRow = FMath::Min(FirstRow + NumRows, Source.Height);
+		auto SourceRow = [&Source](int32 Row)
+		{
+			return Source.Data + static_cast<int64>(Row) * Source.PitchBytes;
+		};
+
+		if constexpr (Layout == EAlakazamPixelLayout::YUV420 || Layout == EAlakazamPixelLayout::NV12)
+		{
+			check((FirstRow & 1) == 0);
+			constexpr bool bInterleaved = Layout == EAlakazamPixelLayout::NV12;
+
+			for (int32 Row = FirstRow; Row < EndRow; Row += 2)
+			{
+				// The last row of an odd-height image pairs with itself
+				const int32 NextRow = FMath::Min(Row + 1, Source.Height - 1);
+				const uint8* Src0 = SourceRow(Row);
+				const uint8* Src1 = SourceRow(NextRow);
+
+				RowWeighted(Src0, Dest.GetRow(0, Row), Width, Weights::Y, YBias);
+				if (NextRow != Row)
+				{
+					RowWeighted(Src1, Dest.GetRow(0, NextRow), Width, Weights::Y, YBias);
+				}
+
+				uint8* DstU = Dest.GetRow(1, Row / 2);
+				uint8* DstV = bInterleaved ? DstU + 1 : Dest.GetRow(2, Row / 2);
+				RowChroma420(Src0, Src1, DstU, DstV, bInterleaved ? 2 : 1, Width, Weights::U, Weights::V);
+			}
+		}
+		else
+		{
+			for (int32 Row = FirstRow; Row < EndRow; Row++)
+			{
+				const uint8* Src = SourceRow(Row);
+
+				if constexpr (Layout == EAlakazamPixelLayout::RGB24)
+				{
+					RowRGB24(Src, Dest.GetRow(0, Row), Width, Weights::RedChannel);
+				}
+				else
+				{
+					RowWeighted(Src, Dest.GetRow(0, Row), Width, Weights::Y, YBias);
+				}
+
+				if constexpr (Layout == EAlakazamPixelLayout::YUV444)
+				{
+					RowWeighted(Src, Dest.GetRow(1, Row), Width, Weights::U, UVBias);
+					RowWeighted(Src, Dest.GetRow(2, Row), Width, Weights::V, UVBias);
+				}
+				else if constexpr (Layout == EAlakazamPixelLayout::YUV422)
+				{
+					// A 2x2 average over a row paired with itself is the horizontal pair average
+					RowChroma420(Src, Src, Dest.GetRow(1, Row), Dest.GetRow(2, Row), 1, Width, Weights::U, Weights::V);
+				}
+			}
+		}
+	}
+
+#define ALAKAZAM_INSTANTIATE_CONVERT(SourceFormat) \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::Luma>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32); \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::RGB24>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32); \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV444>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32); \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV422>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32); \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV420>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32); \
+	template void ConvertRows<SourceFormat, EAlakazamPixelLayout::NV12>(const FAlakazamPixelView&, FAlakazamPlanarImage&, int32, int32);
+
+	ALAKAZAM_INSTANTIATE_CONVERT(EAlakazamSourceFormat::BGRA)
+	ALAKAZAM_INSTANTIATE_CONVERT(EAlakazamSourceFormat::RGBA)
+
+#undef ALAKAZAM_INSTANTIATE_CONVERT
+
+	namespace
+	{
+		template<EAlakazamSourceFormat SourceFormat>
+		void DispatchLayout(const FAlakazamPixelView& Source, FAlakazamPlanarImage& Dest, int32 FirstRow, int32 NumRows)
+		{
+			switch (Dest.Layout)
+			{
+			case EAlakazamPixelLayout::Luma:	ConvertRows<SourceFormat, EAlakazamPixelLayout::Luma>(Source, Dest, FirstRow, NumRows); break;
+			case EAlakazamPixelLayout::RGB24:	ConvertRows<SourceFormat, EAlakazamPixelLayout::RGB24>(Source, Dest, FirstRow, NumRows); break;
+			case EAlakazamPixelLayout::YUV444:	ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV444>(Source, Dest, FirstRow, NumRows); break;
+			case EAlakazamPixelLayout::YUV422:	ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV422>(Source, Dest, FirstRow, NumRows); break;
+			case EAlakazamPixelLayout::YUV420:	ConvertRows<SourceFormat, EAlakazamPixelLayout::YUV420>(Source, Dest, FirstRow, NumRows); break;
+			case EAlakazamPixelLayout::NV12:	ConvertRows<SourceFormat, EAlakazamPixelLayout::NV12>(Source, Dest, FirstRow, NumRows); break;
+			}
+		}
+	}
+
+	void ConvertRows(const FAlakazamPixelView& Source, FAlakazamPlanarImage& Dest, int32 FirstRow, int32 NumRows)
+	{
+		check(Dest.Width == Source.Width && Dest.Height == Source.Height);
+
+		if (Source.Format == EAlakazamSourceFormat::RGBA)
+		{
+			DispatchLayout<EAlakazamSourceFormat::RGBA>(Source, Dest, FirstRow, NumRows);
+		}
+		else
+		{
+			DispatchLayout<EAlakazamSourceFormat::BGRA>(Source, Dest, FirstRow, NumRows);
+		}
+	}
+
+	void Convert(const FAlakazamPixelView& Source, EAlakazamPixelLayout Layout, FAlakazamPlanarImage& Dest, int32 NumBands)
+	{
+		Dest.Allocate(Layout, Source.Width, Source.Height);
+
+		// Bands start on even rows so vertically subsampled chroma rows never straddle two bands
+		const int32 RowsPerBand = FMath::Max(Align(FMath::DivideAndRoundUp(Source.Height, FMath::Max(NumBands, 1)), 2), 2);
+		const int32 ActualBands = FMath::DivideAndRoundUp(Source.Height, RowsPerBand);
+		if (ActualBands <= 1)
+		{
+			ConvertRows(Source, Dest, 0, Source.Height);
+			return;
+		}
+
+		ParallelFor(ActualBands, [&Source, &Dest, RowsPerBand](int32 Band)
+		{
+			ConvertRows(Source, Dest, Band * RowsPerBand, RowsPerBand);
+		});
+	}
+
+	const TCHAR* GetKernelName()
+	{
+#if ALAKAZAM_SIMD_AVX2
+		return TEXT("AVX2");
+#elif ALAKAZAM_SIMD_SSSE3
+		return TEXT("SSSE3");
+#elif ALAKAZAM_SIMD_SSE
+		return TEXT("SSE2");
+#elif ALAKAZAM_SIMD_NEON
+		return TEXT("NEON");
+#else
+		return TEXT("Scalar");
+#endif
+	}
+
+	const TCHAR* GetKernelSetName(EAlakazamKernelSet KernelSet)
+	{
+		switch (KernelSet)
+		{
+		case EAlakazamKernelSet::SSE2:	return TEXT("SSE2");
+		case EAlakazamKernelSet::SSSE3:	return TEXT("SSSE3");
+		case EAlakazamKernelSet::AVX2:	return TEXT("AVX2");
+		case EAlakazamKernelSet::NEON:	return TEXT("NEON");
+		default:						return TEXT("Scalar");
+		}
+	}
+
+	TArray<EAlakazamKernelSet> GetAvailableKernelSets()
+	{
+		TArray<EAlakazamKernelSet> KernelSets = { EAlakazamKernelSet::Scalar };
+#if ALAKAZAM_SIMD_SSE
+		KernelSets.Add(EAlakazamKernelSet::SSE2);
+#endif
+#if ALAKAZAM_SIMD_SSSE3
+		KernelSets.Add(EAlakazamKernelSet::SSSE3);
+#endif
+#if ALAKAZAM_SIMD_AVX2
+		KernelSets.Add(EAlakazamKernelSet::AVX2);
+#endif
+#if ALAKAZAM_SIMD_NEON
+		KernelSets.Add(EAlakazamKernelSet::NEON);
+#endif
+		return KernelSets;
+	}
+
+	void SetMaxKernelSet(EAlakazamKernelSet KernelSet)
+	{
+		MaxKernelSet.store(KernelSet, std::memory_order_relaxed);
+	}
+}
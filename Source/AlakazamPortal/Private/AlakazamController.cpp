@@ -1,5 +1,12 @@
 #include "AlakazamController.h"
 #include "AlakazamAuth.h"
+#include "AlakazamJpegEncoder.h"
+#include "AlakazamStats.h"
+#include "AlakazamImagePrompt.h"
+#include "AlakazamImagePicker.h"
+#include "AlakazamImageResize.h"
+#include "AlakazamStyleCache.h"
+#include "AlakazamStyleBank.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Camera/CameraComponent.h"
@@ -15,16 +22,48 @@
 #include "Serialization/JsonSerializer.h"
 #include "Serialization/JsonWriter.h"
 #include "Misc/Base64.h"
+#include "Async/Async.h"
 #include "RenderGraphUtils.h"
 #include "RHICommandList.h"
+#include "ProfilingDebugging/RealtimeGPUProfiler.h"
+
+DECLARE_GPU_STAT_NAMED(AlakazamReadbackCopy, TEXT("Alakazam Readback Copy"));
+
+namespace
+{
+	// Reference images are sent once, so spend bytes on 4:4:4 and a higher quality than frames
+	constexpr int32 ReferenceJpegQuality = 90;
+
+	// Version of the style bank registration offered in the auth message
+	constexpr int32 StyleBankVersion = 1;
+
+	bool EncodeReferenceImage(const FAlakazamPixelView& Source, int32 MaxEdge, TArray64<uint8>& OutJpeg)
+	{
+		// Style extraction gains nothing from 4K or 8K photos; shrink before encoding
+		FAlakazamPixelView View = Source;
+		TArray<uint8> Downscaled;
+		const FIntPoint Size = AlakazamImageResize::FitWithin(Source.Width, Source.Height, MaxEdge);
+		if (Size.X != Source.Width || Size.Y != Source.Height)
+		{
+			if (!AlakazamImageResize::Downscale(Source, Size.X, Size.Y, Downscaled))
+			{
+				return false;
+			}
+			View.Data = Downscaled.GetData();
+			View.Width = Size.X;
+			View.Height = Size.Y;
+			View.PitchBytes = Size.X * 4;
+		}
+
+		FAlakazamJpegEncoder Encoder;
+		return Encoder.Encode(View, ReferenceJpegQuality, EAlakazamChromaSubsampling::Yuv444, OutJpeg, 0);
+	}
+}
 
 UAlakazamController::UAlakazamController()
 {
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = true;
-
-	// Pre-allocate buffers
-	ReceiveBuffer.SetNumUninitialized(1024 * 1024); // 1MB for received frames
 }
 
 void UAlakazamController::BeginPlay()
@@ -51,16 +90,53 @@ void UAlakazamController::TickComponent(float DeltaTime, ELevelTick TickType, FA
 	// Process any pending async readback
 	ProcessAsyncReadback();
 
-	// Capture and send frames at target FPS
-	if (bIsStreaming && State == EAlakazamState::Ready && !bReadbackPending)
+	// Show the newest reply the decode worker has finished
+	PresentDecodedFrame();
+	RepliesSkipped = RepliesDropped + (DecodePipeline.IsValid() ? DecodePipeline->GetFramesSkipped() : 0);
+
+	SentFrames.Reset();
+	if (EncodePipeline.IsValid())
+	{
+		EncodePipeline->SendEncodedFrames();
+		EncodePipeline->ConsumeSentFrames(SentFrames);
+		FramesSent += SentFrames.Num();
+		EncodeStats = EncodePipeline->GetStats();
+	}
+	for (const FAlakazamSentFrame& SentFrame : SentFrames)
+	{
+		Bitrate.OnFrameSent(SentFrame.SendTime, SentFrame.Bytes, SentFrame.Sequence);
+		Latency.OnSent(SentFrame);
+	}
+	UpdateFramesInFlight(SentFrames.Num());
+
+	SET_DWORD_STAT(STAT_AlakazamEncodeQueueDepth, EncodeStats.QueueDepth);
+	SET_DWORD_STAT(STAT_AlakazamFramesInFlight, FramesInFlight);
+	TRACE_COUNTER_SET(AlakazamEncodeQueueDepth, EncodeStats.QueueDepth);
+	TRACE_COUNTER_SET(AlakazamFramesInFlight, FramesInFlight);
+
+	if (bCaptureSetupDone)
+	{
+		UpdateCaptureSettings();
+	}
+
+	// Capture and send frames at target FPS, while the flow control window has room
+	if (bIsStreaming && State == EAlakazamState::Ready)
 	{
 		FrameTimer += DeltaTime;
 		float FrameInterval = 1.0f / TargetFPS;
 
 		if (FrameTimer >= FrameInterval)
 		{
-			FrameTimer -= FrameInterval;
-			CaptureAndSendFrame();
+			if (MaxFramesInFlight <= 0 || FramesInFlight < MaxFramesInFlight)
+			{
+				FrameTimer -= FrameInterval;
+				CaptureAndSendFrame();
+			}
+			else
+			{
+				// Out of credits: capture as soon as one comes back instead of queueing stale frames
+				FrameTimer = FrameInterval;
+			}
 		}
 	}
 
@@ -71,21 +147,136 @@ void UAlakazamController::TickComponent(float DeltaTime, ELevelTick TickType, FA
 		CurrentFPS = FPSFrameCount / FPSTimer;
 		FPSFrameCount = 0;
 		FPSTimer = 0.0f;
+		LatencyStats = Latency.GetStats();
+	}
+}
+
+void UAlakazamController::UpdateFramesInFlight(int32 NewlySent)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (NewlySent > 0 && FramesAwaitingReply == 0)
+	{
+		LastReplyTime = Now; // The reply timeout starts with the first unanswered frame
+	}
+	FramesAwaitingReply += NewlySent;
+
+	// The server may drop frames without answering; don't let lost credits stall the stream
+	if (FramesAwaitingReply > 0 && Now - LastReplyTime > FrameCreditTimeoutSeconds)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Alakazam: No reply for %.2fs, writing off %d unanswered frames"), Now - LastReplyTime, FramesAwaitingReply);
+		FramesAwaitingReply = 0;
+		Bitrate.OnFramesWrittenOff();
+	}
+
+	// Frames still on this side count against the window too
+	int32 LocalFrames = EncodeStats.QueueDepth;
+	for (const FReadbackSlot& Slot : ReadbackSlots)
+	{
+		const EReadbackSlotState SlotState = Slot.State.load(std::memory_order_acquire);
+		if (SlotState == EReadbackSlotState::Pending || SlotState == EReadbackSlotState::Mapping || SlotState == EReadbackSlotState::Mapped)
+		{
+			LocalFrames++;
+		}
+	}
+	FramesInFlight = FramesAwaitingReply + LocalFrames;
+}
+
+void UAlakazamController::UpdateCaptureSettings()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// Round trip and uplink stats are tracked either way; decisions only apply with adaptive bitrate on
+	if (bAdaptiveBitrate && !bAdaptiveBitrateActive)
+	{
+		Bitrate.Reset();
+	}
+	bAdaptiveBitrateActive = bAdaptiveBitrate;
+
+	Bitrate.SetQualityRange(JpegQuality, MinJpegQuality);
+	const bool bChanged = bIsStreaming && Bitrate.Update(Now);
+	RoundTripMs = Bitrate.GetRoundTripMs();
+	EstimatedUplinkKbps = Bitrate.GetDeliveredKbps();
+
+	FIntPoint TargetSize(CaptureWidth, CaptureHeight);
+	ActiveJpegQuality = JpegQuality;
+	if (bAdaptiveBitrate)
+	{
+		TargetSize = FAlakazamBitrateController::GetRungSize(Bitrate.GetRung(), CaptureWidth, CaptureHeight);
+		ActiveJpegQuality = Bitrate.GetQuality();
+
+		if (bChanged)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Alakazam: Adaptive bitrate now %dx%d at quality %d (round trip %.0f ms, %.0f kbps delivered)"),
+				TargetSize.X, TargetSize.Y, ActiveJpegQuality, RoundTripMs, EstimatedUplinkKbps);
+		}
+	}
+
+	// Also picks up CaptureWidth/Height edited while streaming
+	if (TargetSize != ActiveCaptureSize && TargetSize.X > 0 && TargetSize.Y > 0)
+	{
+		ReallocateCapture(TargetSize.X, TargetSize.Y);
+	}
+}
+
+void UAlakazamController::ReallocateCapture(int32 Width, int32 Height)
+{
+	// Frames being encoded read straight from the readbacks about to be released
+	if (EncodePipeline.IsValid())
+	{
+		EncodePipeline->Flush();
+	}
+	ReleaseReadbackSlots();
+
+	// Readbacks are recreated at the new size on the next capture; the output texture follows the replies
+	for (UTextureRenderTarget2D* Target : CaptureTargets)
+	{
+		Target->ResizeTarget(Width, Height);
 	}
+	ActiveCaptureSize = FIntPoint(Width, Height);
+	ReserveReceiveBuffers(Width, Height);
+
+	UE_LOG(LogTemp, Log, TEXT("Alakazam: Capture resolution changed to %dx%d"), Width, Height);
+}
+
+void UAlakazamController::ReserveReceiveBuffers(int32 Width, int32 Height)
+{
+	// Replies come back at the capture size. A stylized JPEG stays well under a byte per pixel;
+	// anything bigger grows the buffer once and the capacity is kept from then on.
+	ReceiveAssembler.Reserve(FAlakazamFrameHeader::EncodedSize + static_cast<int64>(Width) * Height);
+	DisplayedFrame.Pixels.Reserve(Width * Height * 4);
 }
 
 void UAlakazamController::SetupCapture()
 {
 	if (bCaptureSetupDone) return; // Already set up
 
-	// Create render target for capture
-	CaptureRenderTarget = NewObject<UTextureRenderTarget2D>(this);
-	CaptureRenderTarget->InitCustomFormat(CaptureWidth, CaptureHeight, PF_B8G8R8A8, false);
-	CaptureRenderTarget->UpdateResourceImmediate();
+	// Create the readback ring. In player camera mode every slot gets its own render target,
+	// a manually assigned scene capture keeps rendering into a single shared one.
+	const int32 RingSize = FMath::Clamp(ReadbackRingSize, 1, 8);
+	const int32 NumTargets = bCaptureFromPlayerCamera ? RingSize : 1;
+
+	ActiveCaptureSize = FIntPoint(CaptureWidth, CaptureHeight);
+	ActiveJpegQuality = JpegQuality;
+	ReserveReceiveBuffers(ActiveCaptureSize.X, ActiveCaptureSize.Y);
+
+	CaptureTargets.Reset();
+	for (int32 Index = 0; Index < NumTargets; Index++)
+	{
+		UTextureRenderTarget2D* Target = NewObject<UTextureRenderTarget2D>(this);
+		Target->InitCustomFormat(ActiveCaptureSize.X, ActiveCaptureSize.Y, PF_B8G8R8A8, false);
+		Target->UpdateResourceImmediate();
+		CaptureTargets.Add(Target);
+	}
+	CaptureRenderTarget = CaptureTargets[0];
+
+	ReadbackSlots.SetNum(RingSize);
+	for (int32 Index = 0; Index < RingSize; Index++)
+	{
+		ReadbackSlots[Index].RenderTarget = CaptureTargets[Index % NumTargets];
+	}
 
 	// Create output texture
-	OutputTexture = UTexture2D::CreateTransient(CaptureWidth, CaptureHeight, PF_B8G8R8A8);
-	OutputTexture->UpdateResource();
+	OutputTexture = AcquireOutputTexture(ActiveCaptureSize.X, ActiveCaptureSize.Y);
 
 	// Auto-create scene capture for player camera mode
 	if (bCaptureFromPlayerCamera)
@@ -112,7 +303,7 @@ void UAlakazamController::SetupCapture()
 	}
 
 	bCaptureSetupDone = true;
-	UE_LOG(LogTemp, Log, TEXT("Alakazam: Capture setup complete (%dx%d)"), CaptureWidth, CaptureHeight);
+	UE_LOG(LogTemp, Log, TEXT("Alakazam: Capture setup complete (%dx%d, %d readbacks)"), CaptureWidth, CaptureHeight, RingSize);
 }
 
 void UAlakazamController::Connect()
@@ -126,6 +317,9 @@ void UAlakazamController::Connect()
 	UE_LOG(LogTemp, Log, TEXT("Alakazam: Connecting to %s"), *ServerUrl);
 	State = EAlakazamState::Connecting;
 
+	// After the server closed the last connection the pipelines still hold its socket
+	ReleasePipelines();
+
 	// Create WebSocket
 	WebSocket = FWebSocketsModule::Get().CreateWebSocket(ServerUrl, TEXT(""));
 
@@ -154,6 +348,13 @@ void UAlakazamController::Connect()
 		AuthMsg->SetStringField(TEXT("prompt"), Prompt);
 		AuthMsg->SetStringField(TEXT("api_key"), ApiKey);
 		AuthMsg->SetBoolField(TEXT("enhance"), bEnhancePrompt);
+		AuthMsg->SetNumberField(TEXT("frame_header"), FAlakazamFrameHeader::CurrentVersion);
+		AuthMsg->SetNumberField(TEXT("image_prompt_binary"), AlakazamImagePrompt::CurrentVersion);
+		if (bDeltaFrames)
+		{
+			AuthMsg->SetNumberField(TEXT("delta_frames"), AlakazamDelta::Version);
+		}
+		RegisterStyleBank(*AuthMsg);
 
 		FString AuthStr;
 		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&AuthStr);
@@ -177,6 +378,8 @@ void UAlakazamController::Connect()
 
 	WebSocket->OnMessage().AddLambda([this](const FString& Message)
 	{
+		ALAKAZAM_SCOPE(STAT_AlakazamJsonMessage);
+
 		// Parse JSON message
 		TSharedPtr<FJsonObject> JsonMsg;
 		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Message);
@@ -190,6 +393,31 @@ void UAlakazamController::Connect()
 				SessionId = JsonMsg->GetStringField(TEXT("session_id"));
 				UE_LOG(LogTemp, Log, TEXT("Alakazam: Ready! Session: %s"), *SessionId);
 
+				// Servers that don't echo the frame_header version get bare images, as before
+				int32 FrameHeaderVersion = 0;
+				bFrameHeadersEnabled = JsonMsg->TryGetNumberField(TEXT("frame_header"), FrameHeaderVersion) && FrameHeaderVersion >= 1;
+				UE_LOG(LogTemp, Log, TEXT("Alakazam: Binary frame headers %s"), bFrameHeadersEnabled ? TEXT("enabled") : TEXT("not supported by server"));
+
+				// Delta envelopes would be garbage to a server that can't composite them, so they need the echo too
+				int32 DeltaVersion = 0;
+				bDeltaFramesEnabled = bDeltaFrames && JsonMsg->TryGetNumberField(TEXT("delta_frames"), DeltaVersion) && DeltaVersion >= 1;
+				if (bDeltaFrames)
+				{
+					UE_LOG(LogTemp, Log, TEXT("Alakazam: Delta frames %s"), bDeltaFramesEnabled ? TEXT("enabled") : TEXT("not supported by server, sending keyframes only"));
+				}
+
+				// Likewise reference images fall back to base64 JSON
+				int32 ImagePromptVersion = 0;
+				bBinaryImagePromptsEnabled = JsonMsg->TryGetNumberField(TEXT("image_prompt_binary"), ImagePromptVersion) && ImagePromptVersion >= 1;
+
+				// And style switches fall back to sending the whole prompt
+				int32 BankVersion = 0;
+				bStyleBankEnabled = RegisteredStyles.Num() > 0 && JsonMsg->TryGetNumberField(TEXT("style_bank"), BankVersion) && BankVersion >= 1;
+				if (bStyleBankEnabled)
+				{
+					UE_LOG(LogTemp, Log, TEXT("Alakazam: %d styles registered with the server"), RegisteredStyles.Num());
+				}
+
 				// Process usage info
 				const TSharedPtr<FJsonObject>* UsageObj;
 				if (JsonMsg->TryGetObjectField(TEXT("usage"), UsageObj))
@@ -210,7 +438,7 @@ void UAlakazamController::Connect()
 				State = EAlakazamState::Ready;
 
 				// If we have a pending image for extraction, send it now
-				if (bExtractionOnlyMode && PendingStyleImage)
+				if (bExtractionOnlyMode && PendingStyleImage.Num() > 0)
 				{
 					UE_LOG(LogTemp, Log, TEXT("Alakazam: Extraction-only mode - sending pending image"));
 					SendPendingImageForExtraction();
@@ -233,7 +461,14 @@ void UAlakazamController::Connect()
 				Prompt = ExtractedPrompt;
 				bIsExtractingStyle = false;
 				bIsUsingImageStyle = true;
-				PendingStyleImage = nullptr;
+				PendingStyleImage.Empty();
+				ActiveStyleId = NAME_None;
+				if (!PendingStyleCacheKey.IsEmpty() && StyleCacheMaxKB > 0)
+				{
+					FAlakazamStyleCache::Get().Add(PendingStyleCacheKey, ExtractedPrompt, StyleCacheMaxKB * 1024LL);
+				}
+				PendingStyleCacheKey.Reset();
+				StoreExtractedStylePrompt(ExtractedPrompt);
 				OnStyleExtracted.Broadcast(ExtractedPrompt);
 			}
 		}
@@ -241,28 +476,44 @@ void UAlakazamController::Connect()
 
 	WebSocket->OnRawMessage().AddLambda([this](const void* Data, SIZE_T Size, SIZE_T BytesRemaining)
 	{
-		// Accumulate fragmented binary data
-		if (Size > 0)
+		ALAKAZAM_SCOPE(STAT_AlakazamReceiveMessage);
+		INC_DWORD_STAT_BY(STAT_AlakazamBytesReceived, Size);
+		TRACE_COUNTER_ADD(AlakazamBytesReceived, Size);
+
+		if (!ReceiveAssembler.IsReceiving() && Size > 0)
 		{
-			const uint8* ByteData = static_cast<const uint8*>(Data);
-			ReceiveBuffer.Append(ByteData, Size);
+			ReceiveStartTime = FPlatformTime::Seconds();
 		}
 
-		// Process only when full message is received
-		if (BytesRemaining == 0 && ReceiveBuffer.Num() > 0)
+		// Process only when the full message is received; skip JSON text messages (start with '{')
+		const uint8* Message = nullptr;
+		int64 MessageSize = 0;
+		if (ReceiveAssembler.Add(static_cast<const uint8*>(Data), Size, BytesRemaining, Message, MessageSize) && Message[0] != 0x7B)
 		{
-			// Skip JSON text messages (start with '{')
-			if (ReceiveBuffer[0] != 0x7B)
-			{
-				ProcessReceivedFrame(ReceiveBuffer.GetData(), ReceiveBuffer.Num());
-			}
-			ReceiveBuffer.Reset();
+			ProcessReceivedFrame(Message, static_cast<SIZE_T>(MessageSize));
 		}
 	});
 
 	WebSocket->Connect();
 }
 
+void UAlakazamController::ReleasePipelines()
+{
+	if (EncodePipeline.IsValid())
+	{
+		EncodePipeline->Flush();
+		EncodePipeline.Reset();
+	}
+	if (DecodePipeline.IsValid())
+	{
+		DecodePipeline->Flush();
+		DecodePipeline.Reset();
+	}
+
+	// A message cut off by the close must not prefix the first one of the next connection
+	ReceiveAssembler.Reset();
+}
+
 void UAlakazamController::Disconnect()
 {
 	// Stop streaming first to prevent new captures
@@ -271,47 +522,244 @@ void UAlakazamController::Disconnect()
 	bExtractionOnlyMode = false;
 	State = EAlakazamState::Disconnected;
 
+	// Let frames already handed to the encoder finish before tearing down
+	ReleasePipelines();
+
 	if (WebSocket.IsValid())
 	{
 		WebSocket->Close();
 		WebSocket.Reset();
 	}
 
-	// Flush render commands and wait for GPU to finish before cleanup
-	if (GPUReadback)
-	{
-		// Ensure no pending render commands are using the readback
-		FlushRenderingCommands();
+	ReleaseReadbackSlots();
+	FinishReferenceImagePrep();
+	PendingStyleImage.Empty();
 
-		delete GPUReadback;
-		GPUReadback = nullptr;
+	if (Latency.HasSamples())
+	{
+		const FString SummaryPath = Latency.WriteSessionSummary(SessionId, FramesSent, FramesReceived);
+		if (!SummaryPath.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Alakazam: Wrote latency summary to %s"), *SummaryPath);
+		}
 	}
-	bReadbackPending = false;
-	bReadbackDataReady = false;
-	PendingStyleImage = nullptr;
+	Latency.Reset();
+	LatencyStats = FAlakazamLatencyStats();
 
 	FramesSent = 0;
 	FramesReceived = 0;
+	FramesInFlight = 0;
+	FramesAwaitingReply = 0;
+	Bitrate.Reset();
+	RoundTripMs = 0.0f;
+	EstimatedUplinkKbps = 0.0f;
+	FrameLatencyMs = 0.0f;
+	ServerInferenceMs = 0.0f;
+	bFrameHeadersEnabled = false;
+	bDeltaFramesEnabled = false;
+	bBinaryImagePromptsEnabled = false;
+	bStyleBankEnabled = false;
+	RegisteredStyles.Reset();
+	// Prompt already holds a held-back change, and it goes out with the next auth message
+	CancelPromptFlush();
+	PromptDebounce.Reset();
+	LastReceivedSequence = 0;
+	RepliesDropped = 0;
+	RepliesSkipped = 0;
+	ReadbacksTimedOut = 0;
+	EncodeStats = FAlakazamEncodeStats();
 
 	UE_LOG(LogTemp, Log, TEXT("Alakazam: Disconnected"));
 }
 
-void UAlakazamController::SetPrompt(const FString& NewPrompt)
+void UAlakazamController::SetPrompt(const FString& NewPrompt, bool bImmediate)
 {
 	Prompt = NewPrompt;
+	ActiveStyleId = NAME_None;
+
+	// Offline there is nothing to coalesce
+	const bool bReady = WebSocket.IsValid() && WebSocket->IsConnected() && State == EAlakazamState::Ready;
+	const double Now = FPlatformTime::Seconds();
+	if (!bImmediate && bReady && !PromptDebounce.OnChange(Now, PromptDebounceSeconds))
+	{
+		if (!PromptFlushTicker.IsValid())
+		{
+			const float Delay = static_cast<float>(FMath::Max(PromptDebounce.GetFlushTime(PromptDebounceSeconds) - Now, 0.0));
+			PromptFlushTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAlakazamController::HandlePromptFlushTick), Delay);
+		}
+		return;
+	}
+	SendPrompt(bEnhancePrompt);
+}
+
+void UAlakazamController::FlushPendingPrompt()
+{
+	if (PromptDebounce.IsPending())
+	{
+		SendPrompt(bEnhancePrompt);
+	}
+}
+
+bool UAlakazamController::HandlePromptFlushTick(float DeltaTime)
+{
+	// Returning false removes the ticker
+	PromptFlushTicker.Reset();
+	FlushPendingPrompt();
+	return false;
+}
+
+void UAlakazamController::CancelPromptFlush()
+{
+	if (PromptFlushTicker.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PromptFlushTicker);
+		PromptFlushTicker.Reset();
+	}
+}
+
+bool UAlakazamController::SwitchStyle(FName StyleId)
+{
+	const FAlakazamStyleBankEntry* Entry = StyleBank ? StyleBank->FindStyle(StyleId) : nullptr;
+	if (!Entry)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Alakazam: No style %s in the style bank"), *StyleId.ToString());
+		return false;
+	}
+
+	FString StylePrompt;
+	bool bEnhance = false;
+	if (!ResolveStyle(*Entry, StylePrompt, bEnhance))
+	{
+		return false;
+	}
+
+	Prompt = StylePrompt;
+	bIsUsingImageStyle = Entry->ReferenceImage != nullptr;
+	ActiveStyleId = StyleId;
+
+	// Registered styles are already known to the server, so the ID is all it needs
+	if (bStyleBankEnabled && RegisteredStyles.Contains(StyleId) && WebSocket.IsValid() && WebSocket->IsConnected() && State == EAlakazamState::Ready)
+	{
+		BumpPromptEpoch();
+
+		TSharedPtr<FJsonObject> SwitchMsg = MakeShareable(new FJsonObject);
+		SwitchMsg->SetStringField(TEXT("type"), TEXT("switch_style"));
+		SwitchMsg->SetStringField(TEXT("id"), StyleId.ToString());
+		SwitchMsg->SetNumberField(TEXT("epoch"), PromptEpoch);
+
+		FString SwitchStr;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&SwitchStr);
+		FJsonSerializer::Serialize(SwitchMsg.ToSharedRef(), Writer);
+
+		WebSocket->Send(SwitchStr);
+		UE_LOG(LogTemp, Log, TEXT("Alakazam: Switched to style %s"), *StyleId.ToString());
+	}
+	else
+	{
+		SendPrompt(bEnhance);
+	}
+	return true;
+}
+
+bool UAlakazamController::ResolveStyle(const FAlakazamStyleBankEntry& Entry, FString& OutPrompt, bool& bOutEnhance) const
+{
+	if (!Entry.ReferenceImage)
+	{
+		OutPrompt = Entry.Prompt;
+		bOutEnhance = bEnhancePrompt;
+		return !OutPrompt.IsEmpty();
+	}
+
+	// Extracted prompts are the server's own output and are not enhanced again
+	bOutEnhance = false;
+	OutPrompt = Entry.ExtractedPrompt;
+	if (OutPrompt.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Style %s has no extracted prompt; extract its image in the editor or fill in ExtractedPrompt"), *Entry.Id.ToString());
+		return false;
+	}
+	return true;
+}
+
+void UAlakazamController::StoreExtractedStylePrompt(const FString& ExtractedPrompt)
+{
+#if WITH_EDITOR
+	UTexture2D* Image = ExtractingImage.Get();
+	if (!GIsEditor || !StyleBank || !Image)
+	{
+		ExtractingImage = nullptr;
+		return;
+	}
+
+	bool bModified = false;
+	for (FAlakazamStyleBankEntry& Entry : StyleBank->Styles)
+	{
+		if (Entry.ReferenceImage == Image && Entry.ExtractedPrompt.IsEmpty())
+		{
+			if (!bModified)
+			{
+				StyleBank->Modify();
+				bModified = true;
+			}
+			Entry.ExtractedPrompt = ExtractedPrompt;
+			UE_LOG(LogTemp, Log, TEXT("Alakazam: Stored extracted prompt for style %s in %s"), *Entry.Id.ToString(), *StyleBank->GetName());
+		}
+	}
+#endif
+	ExtractingImage = nullptr;
+}
+
+void UAlakazamController::RegisterStyleBank(FJsonObject& AuthMsg)
+{
+	RegisteredStyles.Reset();
+	if (!StyleBank)
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Styles;
+	for (const FAlakazamStyleBankEntry& Entry : StyleBank->Styles)
+	{
+		FString StylePrompt;
+		bool bEnhance = false;
+		if (Entry.Id.IsNone() || RegisteredStyles.Contains(Entry.Id) || !ResolveStyle(Entry, StylePrompt, bEnhance))
+		{
+			continue;
+		}
+
+		TSharedPtr<FJsonObject> StyleObject = MakeShareable(new FJsonObject);
+		StyleObject->SetStringField(TEXT("id"), Entry.Id.ToString());
+		StyleObject->SetStringField(TEXT("prompt"), StylePrompt);
+		StyleObject->SetBoolField(TEXT("enhance"), bEnhance);
+		Styles.Add(MakeShareable(new FJsonValueObject(StyleObject)));
+		RegisteredStyles.Add(Entry.Id);
+	}
+
+	if (Styles.Num() > 0)
+	{
+		AuthMsg.SetNumberField(TEXT("style_bank"), StyleBankVersion);
+		AuthMsg.SetArrayField(TEXT("styles"), Styles);
+	}
+}
+
+void UAlakazamController::SendPrompt(bool bEnhance)
+{
+	BumpPromptEpoch();
 
 	if (WebSocket.IsValid() && WebSocket->IsConnected() && State == EAlakazamState::Ready)
 	{
 		TSharedPtr<FJsonObject> PromptMsg = MakeShareable(new FJsonObject);
 		PromptMsg->SetStringField(TEXT("type"), TEXT("prompt"));
 		PromptMsg->SetStringField(TEXT("prompt"), Prompt);
-		PromptMsg->SetBoolField(TEXT("enhance"), bEnhancePrompt);
+		PromptMsg->SetBoolField(TEXT("enhance"), bEnhance);
+		PromptMsg->SetNumberField(TEXT("epoch"), PromptEpoch);
 
 		FString PromptStr;
 		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&PromptStr);
 		FJsonSerializer::Serialize(PromptMsg.ToSharedRef(), Writer);
 
 		WebSocket->Send(PromptStr);
+		PromptDebounce.OnSent(FPlatformTime::Seconds());
 		UE_LOG(LogTemp, Log, TEXT("Alakazam: Prompt updated: %s"), *Prompt);
 	}
 }
@@ -324,75 +772,145 @@ void UAlakazamController::SetStyleFromImage(UTexture2D* ReferenceImage)
 		return;
 	}
 
+	// A cache hit needs no connection, so the image is prepared either way
+	bIsExtractingStyle = true;
+	ExtractingImage = ReferenceImage;
+	PrepareReferenceImage(ReferenceImage, [this](TArray64<uint8>& ImageData, const FString& CacheKey)
+	{
+		if (ImageData.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to encode reference image"));
+			bIsExtractingStyle = false;
+			return;
+		}
+		if (ApplyCachedStyle(CacheKey))
+		{
+			return;
+		}
+		if (!IsConnected() || State != EAlakazamState::Ready)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Alakazam: Not ready to set style from image"));
+			bIsExtractingStyle = false;
+			PendingStyleCacheKey.Reset();
+			return;
+		}
+
+		if (SendImagePrompt(ImageData.GetData(), ImageData.Num()))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Alakazam: Sending reference image for style extraction (%lld bytes)"), ImageData.Num());
+		}
+	});
+}
+
+void UAlakazamController::SetStyleFromBase64(const FString& Base64ImageData)
+{
+	PendingStyleCacheKey.Reset();
+	ExtractingImage = nullptr;
+
+	if (Base64ImageData.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Alakazam: Base64 image data is empty"));
+		return;
+	}
+
 	if (!WebSocket.IsValid() || !WebSocket->IsConnected() || State != EAlakazamState::Ready)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Not ready to set style from image"));
 		return;
 	}
 
-	// Set extracting flag
-	bIsExtractingStyle = true;
-
-	// Read texture data
-	FTexture2DMipMap& Mip = ReferenceImage->GetPlatformData()->Mips[0];
-	int32 Width = Mip.SizeX;
-	int32 Height = Mip.SizeY;
-
-	const void* TextureData = Mip.BulkData.LockReadOnly();
-	if (!TextureData)
+	// Already base64: only worth decoding when the server takes the raw bytes
+	if (bBinaryImagePromptsEnabled)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to lock texture data"));
-		bIsExtractingStyle = false;
+		TArray<uint8> ImageData;
+		if (!FBase64::Decode(Base64ImageData, ImageData))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Alakazam: Invalid base64 image data"));
+			return;
+		}
+		SendImagePrompt(ImageData.GetData(), ImageData.Num());
 		return;
 	}
 
-	// Encode to JPEG
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+	BumpPromptEpoch();
+	SendImagePromptJson(Base64ImageData);
+}
 
-	if (ImageWrapper->SetRaw(TextureData, Width * Height * 4, Width, Height, ERGBFormat::BGRA, 8))
+bool UAlakazamController::ApplyCachedStyle(const FString& CacheKey)
+{
+	PendingStyleCacheKey = StyleCacheMaxKB > 0 ? CacheKey : FString();
+	FString CachedPrompt;
+	if (PendingStyleCacheKey.IsEmpty() || !FAlakazamStyleCache::Get().Find(PendingStyleCacheKey, CachedPrompt))
 	{
-		TArray64<uint8> JpegData = ImageWrapper->GetCompressed(90);
-		Mip.BulkData.Unlock();
+		return false;
+	}
+	PendingStyleCacheKey.Reset();
 
-		if (JpegData.Num() > 0)
-		{
-			// Convert to base64
-			FString Base64Data = FBase64::Encode(JpegData.GetData(), JpegData.Num());
-			SetStyleFromBase64(Base64Data);
-			UE_LOG(LogTemp, Log, TEXT("Alakazam: Sending reference image for style extraction (%lld bytes)"), JpegData.Num());
-		}
-		else
-		{
-			bIsExtractingStyle = false;
-		}
+	UE_LOG(LogTemp, Log, TEXT("Alakazam: Style found in cache: %s"), *CachedPrompt);
+	bIsExtractingStyle = false;
+	bIsUsingImageStyle = true;
+	PendingStyleImage.Empty();
+	ActiveStyleId = NAME_None;
+
+	// Already the server's own output, so it is not enhanced again. Sent now when connected,
+	// otherwise it goes out with the auth message on connect.
+	Prompt = CachedPrompt;
+	SendPrompt(false);
+	StoreExtractedStylePrompt(CachedPrompt);
+	OnStyleExtracted.Broadcast(CachedPrompt);
+	return true;
+}
+
+void UAlakazamController::BumpPromptEpoch()
+{
+	// Whatever changes the prompt now supersedes one SetPrompt is holding back
+	PromptDebounce.Cancel();
+	CancelPromptFlush();
+	PromptEpoch++;
+
+	// Measured to the first frame shown with the new prompt; a change made offline has no such frame
+	if (State == EAlakazamState::Ready)
+	{
+		Latency.OnPromptChanged(PromptEpoch, FPlatformTime::Seconds());
 	}
-	else
+	if (DecodePipeline.IsValid())
 	{
-		Mip.BulkData.Unlock();
-		bIsExtractingStyle = false;
-		UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to encode reference image"));
+		DecodePipeline->SetMinPromptEpoch(PromptEpoch);
 	}
 }
 
-void UAlakazamController::SetStyleFromBase64(const FString& Base64ImageData)
+bool UAlakazamController::SendImagePrompt(const uint8* ImageData, int64 ImageSize)
 {
-	if (Base64ImageData.IsEmpty())
+	// Both message forms carry the size in 32 bits
+	if (ImageSize <= 0 || ImageSize > AlakazamImagePrompt::MaxImageSize)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Alakazam: Base64 image data is empty"));
-		return;
+		UE_LOG(LogTemp, Error, TEXT("Alakazam: Reference image of %lld bytes is too large to send (limit %lld)"), ImageSize, AlakazamImagePrompt::MaxImageSize);
+		bIsExtractingStyle = false;
+		return false;
 	}
 
-	if (!WebSocket.IsValid() || !WebSocket->IsConnected() || State != EAlakazamState::Ready)
+	BumpPromptEpoch();
+
+	if (!bBinaryImagePromptsEnabled)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Not ready to set style from image"));
-		return;
+		SendImagePromptJson(FBase64::Encode(ImageData, static_cast<uint32>(ImageSize)));
+		return true;
 	}
 
+	TArray64<uint8> Message;
+	AlakazamImagePrompt::Write(ImageData, ImageSize, PromptEpoch, bEnhancePrompt, Message);
+	WebSocket->Send(Message.GetData(), Message.Num(), true);
+	UE_LOG(LogTemp, Log, TEXT("Alakazam: Sent binary image_prompt message (%lld bytes)"), Message.Num());
+	return true;
+}
+
+void UAlakazamController::SendImagePromptJson(const FString& Base64ImageData)
+{
 	TSharedPtr<FJsonObject> ImagePromptMsg = MakeShareable(new FJsonObject);
 	ImagePromptMsg->SetStringField(TEXT("type"), TEXT("image_prompt"));
 	ImagePromptMsg->SetStringField(TEXT("image_data"), Base64ImageData);
 	ImagePromptMsg->SetBoolField(TEXT("enhance"), bEnhancePrompt);
+	ImagePromptMsg->SetNumberField(TEXT("epoch"), PromptEpoch);
 
 	FString MsgStr;
 	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&MsgStr);
@@ -459,33 +977,54 @@ void UAlakazamController::SyncCaptureWithPlayerCamera()
 	AutoSceneCapture->FOVAngle = CameraManager->GetFOVAngle();
 }
 
+UAlakazamController::FReadbackSlot* UAlakazamController::FindFreeReadbackSlot()
+{
+	for (int32 Offset = 0; Offset < ReadbackSlots.Num(); Offset++)
+	{
+		FReadbackSlot& Slot = ReadbackSlots[(NextCaptureSequence + Offset) % ReadbackSlots.Num()];
+		if (Slot.State.load(std::memory_order_acquire) == EReadbackSlotState::Free)
+		{
+			return &Slot;
+		}
+	}
+	return nullptr;
+}
+
 void UAlakazamController::CaptureAndSendFrame()
 {
+	ALAKAZAM_SCOPE(STAT_AlakazamCaptureAndSend);
+
 	// Early exit if not streaming (prevents captures during shutdown)
 	if (!bIsStreaming || State != EAlakazamState::Ready) return;
-	if (!WebSocket.IsValid() || !WebSocket->IsConnected() || !CaptureRenderTarget) return;
-	if (bReadbackPending) return; // Still waiting for previous readback
+	if (!WebSocket.IsValid() || !WebSocket->IsConnected() || ReadbackSlots.Num() == 0) return;
+
+	// All slots still waiting on the GPU - skip this frame rather than stall
+	FReadbackSlot* Slot = FindFreeReadbackSlot();
+	if (!Slot) return;
 
 	// Sync capture component with player camera before capturing
 	if (bCaptureFromPlayerCamera)
 	{
 		SyncCaptureWithPlayerCamera();
 
-		// Trigger manual capture
+		// Trigger manual capture into this slot's target
 		if (AutoSceneCapture)
 		{
+			// The GPU side shows up under the renderer's own scene capture events
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(AlakazamSceneCapture, AlakazamChannel);
+			AutoSceneCapture->TextureTarget = Slot->RenderTarget;
 			AutoSceneCapture->CaptureScene();
 		}
 	}
 
 	// Get render target resource
-	FTextureRenderTargetResource* RenderTargetResource = CaptureRenderTarget->GameThread_GetRenderTargetResource();
+	FTextureRenderTargetResource* RenderTargetResource = Slot->RenderTarget->GameThread_GetRenderTargetResource();
 	if (!RenderTargetResource) return;
 
 	// Create GPU readback if needed
-	if (!GPUReadback)
+	if (!Slot->Readback)
 	{
-		GPUReadback = new FRHIGPUTextureReadback(TEXT("AlakazamReadback"));
+		Slot->Readback = new FRHIGPUTextureReadback(TEXT("AlakazamReadback"));
 	}
 
 	// Enqueue async readback on render thread
@@ -493,20 +1032,33 @@ void UAlakazamController::CaptureAndSendFrame()
 	if (!TextureRHI) return;
 
 	// Capture local copies for lambda (avoid accessing 'this' members after potential destruction)
-	FRHIGPUTextureReadback* LocalReadback = GPUReadback;
-	int32 LocalWidth = CaptureWidth;
-	int32 LocalHeight = CaptureHeight;
+	FRHIGPUTextureReadback* LocalReadback = Slot->Readback;
+	int32 LocalWidth = ActiveCaptureSize.X;
+	int32 LocalHeight = ActiveCaptureSize.Y;
 
 	ENQUEUE_RENDER_COMMAND(AlakazamAsyncReadback)(
 		[LocalReadback, TextureRHI, LocalWidth, LocalHeight](FRHICommandListImmediate& RHICmdList)
 		{
 			if (LocalReadback)
 			{
+				SCOPED_DRAW_EVENT(RHICmdList, AlakazamReadbackCopy);
+				SCOPED_GPU_STAT(RHICmdList, AlakazamReadbackCopy);
 				LocalReadback->EnqueueCopy(RHICmdList, TextureRHI, FIntVector(0, 0, 0), 0, FIntVector(LocalWidth, LocalHeight, 1));
 			}
 		});
 
-	bReadbackPending = true;
+	Slot->State.store(EReadbackSlotState::Pending);
+	Slot->Sequence = ++NextCaptureSequence;
+	Slot->IssueTime = FPlatformTime::Seconds();
+	if (const USceneCaptureComponent2D* Capture = bCaptureFromPlayerCamera ? AutoSceneCapture : SceneCaptureComponent)
+	{
+		Slot->CameraLocation = Capture->GetComponentLocation();
+		Slot->CameraRotation = Capture->GetComponentRotation();
+		Slot->CameraFOV = Capture->FOVAngle;
+	}
+	Slot->PromptEpoch = PromptEpoch;
+	Latency.OnCaptureIssued(Slot->Sequence, Slot->IssueTime);
+	CaptureRenderTarget = Slot->RenderTarget;
 }
 
 void UAlakazamController::ProcessAsyncReadback()
@@ -514,80 +1066,235 @@ void UAlakazamController::ProcessAsyncReadback()
 	// Early exit if not streaming (prevents processing during shutdown)
 	if (!bIsStreaming) return;
 
-	// Check if we have data ready to send (copied from render thread)
-	if (bReadbackDataReady)
+	ALAKAZAM_SCOPE(STAT_AlakazamProcessReadback);
+
+	const double Now = FPlatformTime::Seconds();
+
+	for (FReadbackSlot& Slot : ReadbackSlots)
 	{
-		FScopeLock Lock(&ReadbackLock);
+		if (Slot.State.load() != EReadbackSlotState::Pending) continue;
 
-		if (ReadbackPixels.Num() > 0 && WebSocket.IsValid() && WebSocket->IsConnected())
+		// Check if readback is ready (this is safe to call from game thread)
+		if (!Slot.Readback->IsReady())
 		{
-			IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-			TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+			// Watchdog: never let a lost readback hold its slot forever
+			if (Now - Slot.IssueTime > ReadbackTimeoutSeconds)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Alakazam: Readback for frame %u timed out after %.2fs, recycling slot"),
+					Slot.Sequence, Now - Slot.IssueTime);
+				RecycleReadbackSlot(Slot);
+				ReadbacksTimedOut++;
+			}
+			continue;
+		}
+
+		// Map the staging memory on the render thread; the encoder reads it in place
+		Slot.State.store(EReadbackSlotState::Mapping);
+		Latency.OnReadbackReady(Slot.Sequence, Now);
+
+		FMappedFrame Frame;
+		Frame.SlotIndex = static_cast<int32>(&Slot - ReadbackSlots.GetData());
+		Frame.Sequence = Slot.Sequence;
+
+		TArray<FReadbackSlot>* SlotsPtr = &ReadbackSlots;
+		TAlakazamSpscQueue<FMappedFrame, 8>* QueuePtr = &MappedFrameQueue;
+		TAlakazamLatestMailbox<FMappedFrame>* MailboxPtr = &LatestMappedFrame;
+		const bool bLatestWins = bLatestFrameWins;
 
-			if (ImageWrapper->SetRaw(ReadbackPixels.GetData(), ReadbackPixels.Num() * sizeof(FColor), CaptureWidth, CaptureHeight, ERGBFormat::BGRA, 8))
+		ENQUEUE_RENDER_COMMAND(AlakazamReadbackMap)(
+			[Frame, SlotsPtr, QueuePtr, MailboxPtr, bLatestWins](FRHICommandListImmediate& RHICmdList)
 			{
-				TArray64<uint8> CompressedData = ImageWrapper->GetCompressed(JpegQuality);
-				if (CompressedData.Num() > 0)
+				FMappedFrame MappedFrame = Frame;
+				FReadbackSlot& MappedSlot = (*SlotsPtr)[MappedFrame.SlotIndex];
+
+				int32 RowPitchInPixels = 0;
+				const void* PixelData = MappedSlot.Readback->Lock(RowPitchInPixels);
+				if (!PixelData || RowPitchInPixels <= 0)
 				{
-					WebSocket->Send(CompressedData.GetData(), CompressedData.Num(), true);
-					FramesSent++;
+					MappedSlot.Readback->Unlock();
+					MappedSlot.State.store(EReadbackSlotState::Free, std::memory_order_release);
+					return;
+				}
 
-					if (FramesSent <= 5 || FramesSent % 100 == 0)
+				MappedFrame.Data = static_cast<const uint8*>(PixelData);
+				MappedFrame.PitchBytes = RowPitchInPixels * sizeof(FColor);
+				MappedFrame.MappedTime = FPlatformTime::Seconds();
+				MappedSlot.State.store(EReadbackSlotState::Mapped, std::memory_order_release);
+
+				if (bLatestWins)
+				{
+					// A frame the game thread never picked up is released right here
+					FMappedFrame Evicted;
+					if (MailboxPtr->Publish(MoveTemp(MappedFrame), Evicted))
 					{
-						UE_LOG(LogTemp, Log, TEXT("Alakazam: Sent frame %d (%lld bytes)"), FramesSent, CompressedData.Num());
+						FReadbackSlot& EvictedSlot = (*SlotsPtr)[Evicted.SlotIndex];
+						EvictedSlot.Readback->Unlock();
+						EvictedSlot.State.store(EReadbackSlotState::Free, std::memory_order_release);
 					}
 				}
-			}
+				else
+				{
+					verify(QueuePtr->Push(MoveTemp(MappedFrame)));
+				}
+			});
+	}
+
+	// Unlock slots the encoder has finished with
+	for (FReadbackSlot& Slot : ReadbackSlots)
+	{
+		if (Slot.State.load(std::memory_order_acquire) == EReadbackSlotState::Encoded)
+		{
+			UnlockReadbackSlot(Slot);
 		}
+	}
 
-		bReadbackDataReady = false;
-		bReadbackPending = false;
-		return;
+	// Hand mapped frames to the encoder; anything older than what was already sent is dropped
+	FMappedFrame Frame;
+	while (MappedFrameQueue.Pop(Frame) || LatestMappedFrame.Consume(Frame))
+	{
+		Latency.OnMapped(Frame.Sequence, Frame.MappedTime);
+
+		if (Frame.Sequence > LastSentSequence && SubmitMappedFrame(Frame))
+		{
+			LastSentSequence = Frame.Sequence;
+		}
+		else
+		{
+			UnlockReadbackSlot(ReadbackSlots[Frame.SlotIndex]);
+		}
 	}
+}
 
-	if (!bReadbackPending || !GPUReadback) return;
+bool UAlakazamController::SubmitMappedFrame(const FMappedFrame& Frame)
+{
+	if (!WebSocket.IsValid() || !WebSocket->IsConnected()) return false;
 
-	// Check if readback is ready (this is safe to call from game thread)
-	if (!GPUReadback->IsReady()) return;
+	if (!EncodePipeline.IsValid())
+	{
+		EncodePipeline = MakeShared<FAlakazamEncodePipeline, ESPMode::ThreadSafe>(WebSocket, MaxEncodeQueueDepth);
+	}
 
-	// Copy data on render thread, then signal game thread
-	int32 Width = CaptureWidth;
-	int32 Height = CaptureHeight;
-	FRHIGPUTextureReadback* Readback = GPUReadback;
-	TArray<FColor>* PixelsPtr = &ReadbackPixels;
-	bool* DataReadyPtr = &bReadbackDataReady;
-	FCriticalSection* LockPtr = &ReadbackLock;
+	// The encoder reads the locked staging memory directly and reports back when it is done with it
+	FReadbackSlot& Slot = ReadbackSlots[Frame.SlotIndex];
+	Slot.State.store(EReadbackSlotState::Encoding);
+
+	FAlakazamEncodeJob Job;
+	Job.SourceData = Frame.Data;
+	Job.SourcePitchBytes = Frame.PitchBytes;
+	Job.Width = ActiveCaptureSize.X;
+	Job.Height = ActiveCaptureSize.Y;
+	Job.Quality = ActiveJpegQuality;
+	Job.Subsampling = ChromaSubsampling;
+	Job.NumStripes = EncodeStripes;
+	Job.Sequence = Frame.Sequence;
+
+	// Most tiles change on a camera cut anyway, so start a fresh keyframe instead of a huge delta
+	Job.bDeltaFrames = bDeltaFrames && bDeltaFramesEnabled;
+	Job.KeyframeInterval = DeltaKeyframeInterval;
+	Job.MaxDirtyFraction = DeltaMaxDirtyFraction;
+	Job.bForceKeyframe = FVector::Dist(Slot.CameraLocation, LastSentCameraLocation) > DeltaCameraCutDistance ||
+		FMath::RadiansToDegrees(Slot.CameraRotation.Quaternion().AngularDistance(LastSentCameraRotation.Quaternion())) > DeltaCameraCutAngle;
+
+	Job.bFrameHeader = bFrameHeadersEnabled;
+	Job.Header.Sequence = Frame.Sequence;
+	Job.Header.PromptEpoch = Slot.PromptEpoch;
+	Job.Header.CaptureTimeUs = FAlakazamFrameHeader::ToTimestampUs(Slot.IssueTime);
+	Job.Header.CameraLocation = FVector3f(Slot.CameraLocation);
+	Job.Header.CameraRotation = FRotator3f(Slot.CameraRotation);
+	Job.Header.CameraFOV = Slot.CameraFOV;
+
+	FReadbackSlot* SlotPtr = &Slot;
+	Job.OnSourceReleased = [SlotPtr]()
+	{
+		SlotPtr->State.store(EReadbackSlotState::Encoded, std::memory_order_release);
+	};
 
-	ENQUEUE_RENDER_COMMAND(AlakazamReadbackCopy)(
-		[Readback, Width, Height, PixelsPtr, DataReadyPtr, LockPtr](FRHICommandListImmediate& RHICmdList)
-		{
-			int32 RowPitchInPixels = 0;
-			const FColor* PixelData = static_cast<const FColor*>(Readback->Lock(RowPitchInPixels));
+	if (!EncodePipeline->Submit(MoveTemp(Job)))
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Alakazam: Encode queue full, dropped frame %u"), Frame.Sequence);
+		return false;
+	}
 
-			if (PixelData && RowPitchInPixels > 0)
-			{
-				FScopeLock Lock(LockPtr);
-				PixelsPtr->SetNum(Width * Height);
-				for (int32 Row = 0; Row < Height; Row++)
-				{
-					FMemory::Memcpy(
-						PixelsPtr->GetData() + Row * Width,
-						PixelData + Row * RowPitchInPixels,
-						Width * sizeof(FColor)
-					);
-				}
-				*DataReadyPtr = true;
-			}
+	LastSentCameraLocation = Slot.CameraLocation;
+	LastSentCameraRotation = Slot.CameraRotation;
+	return true;
+}
 
+void UAlakazamController::UnlockReadbackSlot(FReadbackSlot& Slot)
+{
+	// Copies into this slot are enqueued after the unlock, so the slot can be reused right away
+	FRHIGPUTextureReadback* Readback = Slot.Readback;
+	ENQUEUE_RENDER_COMMAND(AlakazamReadbackUnlock)(
+		[Readback](FRHICommandListImmediate& RHICmdList)
+		{
 			Readback->Unlock();
 		});
+
+	Slot.State.store(EReadbackSlotState::Free);
+}
+
+void UAlakazamController::RecycleReadbackSlot(FReadbackSlot& Slot)
+{
+	// The GPU may still reference the stuck readback, so let the render thread delete it
+	FRHIGPUTextureReadback* StuckReadback = Slot.Readback;
+	ENQUEUE_RENDER_COMMAND(AlakazamRecycleReadback)(
+		[StuckReadback](FRHICommandListImmediate& RHICmdList)
+		{
+			delete StuckReadback;
+		});
+
+	Slot.Readback = nullptr; // Recreated on next capture
+	Slot.State.store(EReadbackSlotState::Free);
+}
+
+void UAlakazamController::ReleaseReadbackSlots()
+{
+	if (ReadbackSlots.Num() == 0) return;
+
+	// Ensure no pending render commands are using the readbacks
+	FlushRenderingCommands();
+
+	// The encoder has been flushed, so anything still mapped only needs unlocking
+	FMappedFrame Frame;
+	while (MappedFrameQueue.Pop(Frame) || LatestMappedFrame.Consume(Frame))
+	{
+		UnlockReadbackSlot(ReadbackSlots[Frame.SlotIndex]);
+	}
+	for (FReadbackSlot& Slot : ReadbackSlots)
+	{
+		if (Slot.State.load() == EReadbackSlotState::Encoded)
+		{
+			UnlockReadbackSlot(Slot);
+		}
+	}
+	FlushRenderingCommands();
+
+	for (FReadbackSlot& Slot : ReadbackSlots)
+	{
+		delete Slot.Readback;
+		Slot.Readback = nullptr;
+		Slot.State.store(EReadbackSlotState::Free);
+	}
+	LastSentSequence = NextCaptureSequence;
 }
 
 void UAlakazamController::ProcessReceivedFrame(const void* Data, SIZE_T Size)
 {
-	if (Size < 8) return;
+	ALAKAZAM_SCOPE(STAT_AlakazamProcessReceivedFrame);
 
 	const uint8* Bytes = static_cast<const uint8*>(Data);
+	const double Now = FPlatformTime::Seconds();
+
+	// Negotiated frame header: the server echoes ours, then the image follows
+	FAlakazamFrameHeader Header;
+	const int64 HeaderSize = FAlakazamFrameHeader::Read(Bytes, Size, Header);
+	if (HeaderSize > 0)
+	{
+		Bytes += HeaderSize;
+		Size -= HeaderSize;
+	}
+
+	if (Size < 8) return;
 
 	// Detect image format from magic bytes
 	EImageFormat Format = EImageFormat::Invalid;
@@ -606,43 +1313,201 @@ void UAlakazamController::ProcessReceivedFrame(const void* Data, SIZE_T Size)
 		return;
 	}
 
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format);
+	// Any stylized frame answers the oldest outstanding one and returns its credit
+	FramesAwaitingReply = FMath::Max(0, FramesAwaitingReply - 1);
+	LastReplyTime = Now;
 
-	if (ImageWrapper->SetCompressed(Data, Size))
+	if (HeaderSize > 0)
 	{
-		TArray<uint8> RawData;
-		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData))
+		// Timed against the frame it echoes, so a skipped or reordered reply doesn't shift the pairing
+		Bitrate.OnFrameAnswered(Now, Header.Sequence);
+
+		// Replies can overtake each other; never show an older frame over a newer one
+		if (Header.Sequence <= LastReceivedSequence)
 		{
-			// Update output texture
-			if (OutputTexture)
-			{
-				FTexture2DMipMap& Mip = OutputTexture->GetPlatformData()->Mips[0];
-				void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
-				FMemory::Memcpy(TextureData, RawData.GetData(), RawData.Num());
-				Mip.BulkData.Unlock();
-				OutputTexture->UpdateResource();
+			UE_LOG(LogTemp, Verbose, TEXT("Alakazam: Dropped stale frame %u (already have %u)"), Header.Sequence, LastReceivedSequence);
+			RepliesDropped++;
+			return;
+		}
 
-				OnFrameReceived.Broadcast(OutputTexture);
-			}
+		// Stylized with a prompt that has since been replaced
+		if (Header.PromptEpoch < PromptEpoch)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Alakazam: Dropped frame %u from prompt epoch %u (now %u)"), Header.Sequence, Header.PromptEpoch, PromptEpoch);
+			RepliesDropped++;
+			return;
+		}
+		LastReceivedSequence = Header.Sequence;
+	}
+	else
+	{
+		Bitrate.OnFrameAnswered(Now);
+	}
 
-			FramesReceived++;
-			FPSFrameCount++;
+	if (!DecodePipeline.IsValid())
+	{
+		DecodePipeline = MakeShared<FAlakazamDecodePipeline, ESPMode::ThreadSafe>();
+		DecodePipeline->SetMinPromptEpoch(PromptEpoch);
+	}
 
-			if (FramesReceived <= 5 || FramesReceived % 100 == 0)
-			{
-				UE_LOG(LogTemp, Log, TEXT("Alakazam: Received frame %d (%d bytes, %s)"),
-					FramesReceived, (int32)Size, Format == EImageFormat::JPEG ? TEXT("JPEG") : TEXT("PNG"));
-			}
+	FAlakazamReplyInfo Info;
+	Info.Header = Header;
+	Info.bHasHeader = HeaderSize > 0;
+	Info.bPng = Format == EImageFormat::PNG;
+	Info.FirstByteTime = ReceiveStartTime;
+	DecodePipeline->Submit(Bytes, Size, Info);
+}
+
+void UAlakazamController::PresentDecodedFrame()
+{
+	if (!DecodePipeline.IsValid() || !DecodePipeline->ConsumeDecoded(DisplayedFrame))
+	{
+		return;
+	}
+
+	// The prompt may have changed while the frame was being decoded
+	const FAlakazamReplyInfo& Info = DisplayedFrame.Info;
+	if (Info.bHasHeader && Info.Header.PromptEpoch < PromptEpoch)
+	{
+		RepliesDropped++;
+		return;
+	}
+
+	double UploadedTime = DisplayedFrame.DecodedTime;
+
+	// Update output texture
+	if (OutputTexture)
+	{
+		// Replies follow the capture resolution, which adaptive bitrate may have changed
+		if (OutputTexture->GetSizeX() != DisplayedFrame.Width || OutputTexture->GetSizeY() != DisplayedFrame.Height)
+		{
+			OutputTexture = AcquireOutputTexture(DisplayedFrame.Width, DisplayedFrame.Height);
+		}
+
+		if (!UploadOutputTexture(DisplayedFrame.Pixels, DisplayedFrame.Width, DisplayedFrame.Height, Info))
+		{
+			RepliesDropped++;
+			return;
 		}
+		UploadedTime = FPlatformTime::Seconds();
+
+		OnFrameReceived.Broadcast(OutputTexture);
+		OnFrameReceivedNative.Broadcast(OutputTexture, Info);
 	}
-	else
+
+	if (Info.bHasHeader)
+	{
+		FrameLatencyMs = static_cast<float>((UploadedTime - FAlakazamFrameHeader::FromTimestampUs(Info.Header.CaptureTimeUs)) * 1000.0);
+		ServerInferenceMs = Info.Header.InferenceMs;
+	}
+	Latency.OnReplyShown(Info.bHasHeader ? Info.Header.Sequence : 0, Info.FirstByteTime, DisplayedFrame.DecodedTime, UploadedTime);
+	if (Info.bHasHeader)
+	{
+		Latency.OnPromptShown(Info.Header.PromptEpoch, UploadedTime);
+	}
+
+	FramesReceived++;
+	FPSFrameCount++;
+
+	if (FramesReceived <= 5 || FramesReceived % 100 == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Alakazam: Received frame %d (%lld bytes, %s)"),
+			FramesReceived, DisplayedFrame.CompressedSize, Info.bPng ? TEXT("PNG") : TEXT("JPEG"));
+	}
+}
+
+void UAlakazamController::SetFrameUploadedCallback(FAlakazamFrameUploadedCallback Callback)
+{
+	FrameUploadedCallback.Reset();
+	if (Callback)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Failed to decompress %s frame (%d bytes)"),
-			Format == EImageFormat::JPEG ? TEXT("JPEG") : TEXT("PNG"), (int32)Size);
+		FrameUploadedCallback = MakeShared<FAlakazamFrameUploadedCallback, ESPMode::ThreadSafe>(MoveTemp(Callback));
 	}
 }
 
+UTexture2D* UAlakazamController::AcquireOutputTexture(int32 Width, int32 Height)
+{
+	for (int32 Index = 0; Index < OutputTexturePool.Num(); Index++)
+	{
+		UTexture2D* Texture = OutputTexturePool[Index];
+		if (Texture && Texture->GetSizeX() == Width && Texture->GetSizeY() == Height)
+		{
+			OutputTexturePool.RemoveAt(Index);
+			OutputTexturePool.Add(Texture);
+			return Texture;
+		}
+	}
+
+	// One texture per adaptive bitrate rung is enough; the least recently used goes
+	if (OutputTexturePool.Num() >= FAlakazamBitrateController::NumRungs)
+	{
+		OutputTexturePool.RemoveAt(0);
+	}
+
+	UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
+	Texture->UpdateResource();
+	OutputTexturePool.Add(Texture);
+	return Texture;
+}
+
+bool UAlakazamController::UploadOutputTexture(TArray<uint8>& Pixels, int32 Width, int32 Height, const FAlakazamReplyInfo& Info)
+{
+	ALAKAZAM_SCOPE(STAT_AlakazamUploadFrame);
+
+	FTextureResource* Resource = OutputTexture->GetResource();
+	if (!Resource || Pixels.Num() < Width * Height * 4)
+	{
+		return false;
+	}
+
+	// Double buffered: one upload can be waiting on the render thread while the next is queued
+	constexpr int32 NumUploadBuffers = 2;
+	TSharedPtr<FUploadBuffer, ESPMode::ThreadSafe> Buffer;
+	for (const TSharedRef<FUploadBuffer, ESPMode::ThreadSafe>& Candidate : UploadBuffers)
+	{
+		if (!Candidate->bInUse.load(std::memory_order_acquire))
+		{
+			Buffer = Candidate;
+			break;
+		}
+	}
+	if (!Buffer.IsValid())
+	{
+		// Render thread is behind; a newer frame will come along
+		if (UploadBuffers.Num() >= NumUploadBuffers)
+		{
+			return false;
+		}
+		Buffer = UploadBuffers.Add_GetRef(MakeShared<FUploadBuffer, ESPMode::ThreadSafe>());
+	}
+
+	// The free buffer's allocation goes back to the caller, so nothing is copied or allocated
+	Swap(Buffer->Pixels, Pixels);
+	Buffer->bInUse.store(true);
+
+	// Straight into the existing RHI texture, instead of recreating it through UpdateResource
+	TSharedRef<FUploadBuffer, ESPMode::ThreadSafe> UploadBuffer = Buffer.ToSharedRef();
+	TSharedPtr<FAlakazamFrameUploadedCallback, ESPMode::ThreadSafe> Callback = FrameUploadedCallback;
+	ENQUEUE_RENDER_COMMAND(AlakazamUploadOutput)(
+		[Resource, UploadBuffer, Width, Height, Callback, Info](FRHICommandListImmediate& RHICmdList)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(AlakazamUploadOutput, AlakazamChannel);
+			FRHITexture2D* TextureRHI = Resource->GetTexture2DRHI();
+			if (TextureRHI)
+			{
+				const FUpdateTextureRegion2D Region(0, 0, 0, 0, Width, Height);
+				RHIUpdateTexture2D(TextureRHI, 0, Region, Width * 4, UploadBuffer->Pixels.GetData());
+			}
+			UploadBuffer->bInUse.store(false, std::memory_order_release);
+
+			if (TextureRHI && Callback.IsValid())
+			{
+				(*Callback)(RHICmdList, TextureRHI, Info);
+			}
+		});
+	return true;
+}
+
 void UAlakazamController::ExtractStyleFromImage(UTexture2D* ReferenceImage)
 {
 	if (!ReferenceImage)
@@ -651,29 +1516,49 @@ void UAlakazamController::ExtractStyleFromImage(UTexture2D* ReferenceImage)
 		return;
 	}
 
-	PendingStyleImage = ReferenceImage;
 	bIsExtractingStyle = true;
-	bExtractionOnlyMode = true;
-
-	if (!IsConnected())
+	ExtractingImage = ReferenceImage;
+	PrepareReferenceImage(ReferenceImage, [this](TArray64<uint8>& ImageData, const FString& CacheKey)
 	{
-		// Auto-connect for extraction only (no streaming)
-		UE_LOG(LogTemp, Log, TEXT("Alakazam: Connecting for style extraction..."));
-		ConnectForExtractionOnly();
-	}
-	else if (State == EAlakazamState::Ready)
-	{
-		// Already connected and ready - send extraction request immediately
-		SendPendingImageForExtraction();
-	}
-	// else: connected but not ready yet - will be handled when "ready" is received
+		if (ImageData.Num() == 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to encode image for extraction"));
+			bIsExtractingStyle = false;
+			return;
+		}
+
+		// A cache hit needs no server, so don't connect for it
+		if (ApplyCachedStyle(CacheKey))
+		{
+			return;
+		}
+
+		PendingStyleImage = MoveTemp(ImageData);
+		bExtractionOnlyMode = true;
+
+		if (!IsConnected())
+		{
+			// Auto-connect for extraction only (no streaming)
+			UE_LOG(LogTemp, Log, TEXT("Alakazam: Connecting for style extraction..."));
+			ConnectForExtractionOnly();
+		}
+		else if (State == EAlakazamState::Ready)
+		{
+			// Already connected and ready - send extraction request immediately
+			SendPendingImageForExtraction();
+		}
+		// else: connected but not ready yet - will be handled when "ready" is received
+	});
 }
 
 void UAlakazamController::ClearImageStyle()
 {
 	bIsUsingImageStyle = false;
 	bIsExtractingStyle = false;
-	PendingStyleImage = nullptr;
+	PendingStyleImage.Empty();
+	PendingStyleCacheKey.Reset();
+	ExtractingImage = nullptr;
+	FinishReferenceImagePrep();
 }
 
 void UAlakazamController::ConnectForExtractionOnly()
@@ -687,64 +1572,136 @@ void UAlakazamController::ConnectForExtractionOnly()
 
 void UAlakazamController::SendPendingImageForExtraction()
 {
-	if (!PendingStyleImage)
+	if (PendingStyleImage.Num() == 0)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Alakazam: No pending image for extraction"));
 		bIsExtractingStyle = false;
 		return;
 	}
 
-	// Read texture data
-	FTexture2DMipMap& Mip = PendingStyleImage->GetPlatformData()->Mips[0];
-	int32 Width = Mip.SizeX;
-	int32 Height = Mip.SizeY;
-
-	const void* TextureData = Mip.BulkData.LockReadOnly();
-	if (!TextureData)
+	if (SendImagePrompt(PendingStyleImage.GetData(), PendingStyleImage.Num()))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to lock texture data for extraction"));
-		bIsExtractingStyle = false;
-		PendingStyleImage = nullptr;
-		return;
+		UE_LOG(LogTemp, Log, TEXT("Alakazam: Sent image for style extraction (%lld bytes)"), PendingStyleImage.Num());
 	}
+}
 
-	// Encode to JPEG
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
-
-	if (ImageWrapper->SetRaw(TextureData, Width * Height * 4, Width, Height, ERGBFormat::BGRA, 8))
+void UAlakazamController::PrepareReferenceImage(UTexture2D* Image, TFunction<void(TArray64<uint8>& ImageData, const FString& CacheKey)> OnPrepared)
+{
+	// Only the latest request matters; an older one still running is waited out and forgotten
+	FinishReferenceImagePrep();
+
+	// Images loaded from disk keep their file, which beats decoding and re-encoding the pixels,
+	// as long as it needs no downscaling
+	FAlakazamPixelView View;
+	const int32 MaxEdge = ReferenceImageMaxEdge;
+	const UAlakazamSourceImageData* Source = Image->GetAssetUserData<UAlakazamSourceImageData>();
+	const bool bFitsMaxEdge = MaxEdge <= 0 || FMath::Max(Image->GetSizeX(), Image->GetSizeY()) <= MaxEdge;
+	const uint8* FileData = nullptr;
+	int64 FileSize = 0;
+	if (Source && Source->FileData.Num() > 0 && bFitsMaxEdge)
+	{
+		FileData = Source->FileData.GetData();
+		FileSize = Source->FileData.Num();
+	}
+	else
 	{
-		TArray64<uint8> JpegData = ImageWrapper->GetCompressed(90);
-		Mip.BulkData.Unlock();
+		const void* TextureData = nullptr;
+		FTexture2DPlatformData* PlatformData = Image->GetPlatformData();
+		if (PlatformData && PlatformData->Mips.Num() > 0 && PlatformData->PixelFormat == PF_B8G8R8A8)
+		{
+			FTexture2DMipMap& Mip = PlatformData->Mips[0];
+			TextureData = Mip.BulkData.LockReadOnly();
+			bPreparingMipLocked = TextureData != nullptr;
+			View.Width = Mip.SizeX;
+			View.Height = Mip.SizeY;
+		}
+#if WITH_EDITORONLY_DATA
+		// Imported textures are GPU-compressed, but the editor still has their source art
+		else if (Image->Source.IsValid() && Image->Source.GetFormat() == TSF_BGRA8)
+		{
+			TextureData = Image->Source.LockMipReadOnly(0, 0, 0);
+			bPreparingSourceLocked = TextureData != nullptr;
+			View.Width = Image->Source.GetSizeX();
+			View.Height = Image->Source.GetSizeY();
+		}
+#endif
 
-		if (JpegData.Num() > 0)
+		if (!TextureData)
 		{
-			// Convert to base64 and send
-			FString Base64Data = FBase64::Encode(JpegData.GetData(), JpegData.Num());
+			UE_LOG(LogTemp, Error, TEXT("Alakazam: Reference image must be an uncompressed BGRA8 texture, or have BGRA8 source art in the editor"));
+			TArray64<uint8> Empty;
+			OnPrepared(Empty, FString());
+			return;
+		}
+
+		View.Data = static_cast<const uint8*>(TextureData);
+		View.PitchBytes = View.Width * 4;
+		View.Format = EAlakazamSourceFormat::BGRA;
+	}
 
-			TSharedPtr<FJsonObject> ImagePromptMsg = MakeShareable(new FJsonObject);
-			ImagePromptMsg->SetStringField(TEXT("type"), TEXT("image_prompt"));
-			ImagePromptMsg->SetStringField(TEXT("image_data"), Base64Data);
-			ImagePromptMsg->SetBoolField(TEXT("enhance"), bEnhancePrompt);
+	PreparingImage = Image;
+	const uint32 PrepId = ++ReferencePrepId;
+	const bool bCacheKey = StyleCacheMaxKB > 0;
+	const bool bEnhance = bEnhancePrompt;
+	TWeakObjectPtr<UAlakazamController> WeakThis(this);
 
-			FString MsgStr;
-			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&MsgStr);
-			FJsonSerializer::Serialize(ImagePromptMsg.ToSharedRef(), Writer);
+	// The file or mip belongs to PreparingImage, which FinishReferenceImagePrep waits on before letting go
+	ReferencePrepTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [View, FileData, FileSize, MaxEdge, bCacheKey, bEnhance, PrepId, WeakThis, OnPrepared = MoveTemp(OnPrepared)]() mutable
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(AlakazamPrepareReferenceImage, AlakazamChannel);
 
-			WebSocket->Send(MsgStr);
-			UE_LOG(LogTemp, Log, TEXT("Alakazam: Sent image for style extraction (%lld bytes)"), JpegData.Num());
+		TSharedRef<TArray64<uint8>, ESPMode::ThreadSafe> ImageData = MakeShared<TArray64<uint8>, ESPMode::ThreadSafe>();
+		if (FileData)
+		{
+			ImageData->Append(FileData, FileSize);
 		}
-		else
+		else if (!EncodeReferenceImage(View, MaxEdge, *ImageData))
 		{
-			bIsExtractingStyle = false;
-			PendingStyleImage = nullptr;
+			ImageData->Reset();
+		}
+
+		// Keyed by the bytes that get uploaded, which are small next to the source pixels
+		FString CacheKey;
+		if (bCacheKey && ImageData->Num() > 0)
+		{
+			CacheKey = FAlakazamStyleCache::MakeKey(ImageData->GetData(), ImageData->Num(), bEnhance);
 		}
+
+		AsyncTask(ENamedThreads::GameThread, [PrepId, WeakThis, ImageData, CacheKey = MoveTemp(CacheKey), OnPrepared = MoveTemp(OnPrepared)]()
+		{
+			UAlakazamController* Self = WeakThis.Get();
+			if (!Self || Self->ReferencePrepId != PrepId || !Self->PreparingImage)
+			{
+				return;
+			}
+			Self->FinishReferenceImagePrep();
+			OnPrepared(*ImageData, CacheKey);
+		});
+	});
+}
+
+void UAlakazamController::FinishReferenceImagePrep()
+{
+	if (!PreparingImage)
+	{
+		return;
 	}
-	else
+
+	// Normally already done; otherwise the mip can't be unlocked under the worker's feet
+	ReferencePrepTask.Wait();
+	ReferencePrepTask = UE::Tasks::FTask();
+
+	if (bPreparingMipLocked)
 	{
-		Mip.BulkData.Unlock();
-		bIsExtractingStyle = false;
-		PendingStyleImage = nullptr;
-		UE_LOG(LogTemp, Error, TEXT("Alakazam: Failed to encode image for extraction"));
+		PreparingImage->GetPlatformData()->Mips[0].BulkData.Unlock();
+		bPreparingMipLocked = false;
+	}
+#if WITH_EDITORONLY_DATA
+	if (bPreparingSourceLocked)
+	{
+		PreparingImage->Source.UnlockMip(0, 0, 0);
+		bPreparingSourceLocked = false;
 	}
+#endif
+	PreparingImage = nullptr;
 }
@@ -20,6 +20,14 @@ TSharedRef<IDetailCustomization> FAlakazamControllerDetails::MakeInstance()
 	return MakeShareable(new FAlakazamControllerDetails);
 }
 
+FAlakazamControllerDetails::~FAlakazamControllerDetails()
+{
+	if (PendingLoad.IsValid())
+	{
+		PendingLoad->Cancel();
+	}
+}
+
 void FAlakazamControllerDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 {
 	// Get the object being edited
@@ -173,7 +181,20 @@ FReply FAlakazamControllerDetails::OnExtractClicked()
 
 void FAlakazamControllerDetails::LoadImageFromPath(const FString& FilePath)
 {
-	UTexture2D* Texture = UAlakazamImagePicker::LoadImageFromFile(FilePath);
+	if (PendingLoad.IsValid())
+	{
+		PendingLoad->Cancel();
+	}
+
+	UAlakazamLoadImageAsync* Load = UAlakazamLoadImageAsync::LoadImageFromFileAsync(nullptr, FilePath);
+	Load->OnCompleteNative.AddRaw(this, &FAlakazamControllerDetails::HandleImageLoaded, FilePath);
+	PendingLoad = Load;
+	Load->Activate();
+}
+
+void FAlakazamControllerDetails::HandleImageLoaded(UTexture2D* Texture, FString FilePath)
+{
+	PendingLoad.Reset();
 	if (Texture)
 	{
 		LoadedTexture = Texture;
@@ -200,6 +221,11 @@ FText FAlakazamControllerDetails::GetStatusText() const
 		return FText::FromString(TEXT("Style ready"));
 	}
 
+	if (PendingLoad.IsValid() && PendingLoad->IsLoading())
+	{
+		return FText::FromString(TEXT("Loading image..."));
+	}
+
 	if (!LoadedImagePath.IsEmpty())
 	{
 		return FText::FromString(FString::Printf(TEXT("Loaded: %s"), *FPaths::GetCleanFilename(LoadedImagePath)));
@@ -0,0 +1,150 @@
+#include "AlakazamDecodePipeline.h"
+#include "AlakazamStats.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+FAlakazamDecodePipeline::FAlakazamDecodePipeline()
+{
+	// Module lookups belong on the game thread, so the fallback decoders are made up front
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	JpegWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+	PngWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+}
+
+bool FAlakazamDecodePipeline::Submit(const uint8* Data, int64 Size, const FAlakazamReplyInfo& Info)
+{
+	FScopeLock Lock(&PendingLock);
+
+	const bool bReplaced = bHasPending;
+	if (bReplaced)
+	{
+		FramesSkipped++;
+	}
+
+	Pending.Info = Info;
+	Pending.Data.Reset();
+	Pending.Data.Append(Data, Size);
+	bHasPending = true;
+
+	// A running worker picks the payload up when it finishes the current one
+	if (!bWorkerRunning)
+	{
+		bWorkerRunning = true;
+		TSharedRef<FAlakazamDecodePipeline, ESPMode::ThreadSafe> Self = AsShared();
+		WorkerTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Self]()
+		{
+			Self->RunWorker();
+		});
+	}
+	return !bReplaced;
+}
+
+void FAlakazamDecodePipeline::RunWorker()
+{
+	for (;;)
+	{
+		{
+			FScopeLock Lock(&PendingLock);
+			if (!bHasPending)
+			{
+				bWorkerRunning = false;
+				return;
+			}
+
+			// Swap rather than copy, so both payload buffers keep their capacity
+			Swap(Pending.Data, Working.Data);
+			Working.Info = Pending.Info;
+			bHasPending = false;
+		}
+
+		// A prompt change since this payload was queued makes it stale
+		if (Working.Info.bHasHeader && Working.Info.Header.PromptEpoch < MinPromptEpoch.load())
+		{
+			FramesSkipped++;
+			continue;
+		}
+
+		if (!Decode(Working, DecodeTarget))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Alakazam: Failed to decompress %s frame (%d bytes)"),
+				Working.Info.bPng ? TEXT("PNG") : TEXT("JPEG"), Working.Data.Num());
+			continue;
+		}
+
+		FScopeLock Lock(&ResultLock);
+		if (bHasResult)
+		{
+			FramesSkipped++;
+		}
+		Swap(Result.Pixels, DecodeTarget.Pixels);
+		Result.Info = DecodeTarget.Info;
+		Result.Width = DecodeTarget.Width;
+		Result.Height = DecodeTarget.Height;
+		Result.CompressedSize = DecodeTarget.CompressedSize;
+		Result.DecodedTime = DecodeTarget.DecodedTime;
+		bHasResult = true;
+	}
+}
+
+bool FAlakazamDecodePipeline::Decode(const FPayload& Payload, FAlakazamDecodedFrame& OutFrame)
+{
+	ALAKAZAM_SCOPE(STAT_AlakazamDecodeFrame);
+
+	const uint8* Data = Payload.Data.GetData();
+	const int64 Size = Payload.Data.Num();
+	OutFrame.Info = Payload.Info;
+	OutFrame.CompressedSize = Size;
+
+	// Frames with restart markers are decoded in parallel stripes
+	bool bDecoded = false;
+	if (!Payload.Info.bPng)
+	{
+		bDecoded = JpegDecoder.Decode(Data, Size, OutFrame.Pixels, OutFrame.Width, OutFrame.Height);
+	}
+
+	// Otherwise decode the whole image in one go
+	if (!bDecoded)
+	{
+		const TSharedPtr<IImageWrapper>& ImageWrapper = Payload.Info.bPng ? PngWrapper : JpegWrapper;
+		bDecoded = ImageWrapper.IsValid() && ImageWrapper->SetCompressed(Data, Size) && ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutFrame.Pixels);
+		if (bDecoded)
+		{
+			OutFrame.Width = ImageWrapper->GetWidth();
+			OutFrame.Height = ImageWrapper->GetHeight();
+		}
+	}
+
+	OutFrame.DecodedTime = FPlatformTime::Seconds();
+	return bDecoded;
+}
+
+bool FAlakazamDecodePipeline::ConsumeDecoded(FAlakazamDecodedFrame& OutFrame)
+{
+	FScopeLock Lock(&ResultLock);
+	if (!bHasResult)
+	{
+		return false;
+	}
+
+	Swap(OutFrame.Pixels, Result.Pixels);
+	OutFrame.Info = Result.Info;
+	OutFrame.Width = Result.Width;
+	OutFrame.Height = Result.Height;
+	OutFrame.CompressedSize = Result.CompressedSize;
+	OutFrame.DecodedTime = Result.DecodedTime;
+	bHasResult = false;
+	return true;
+}
+
+void FAlakazamDecodePipeline::Flush()
+{
+	UE::Tasks::FTask Task;
+	{
+		FScopeLock Lock(&PendingLock);
+		Task = WorkerTask;
+	}
+	if (Task.IsValid())
+	{
+		Task.Wait();
+	}
+}
@@ -0,0 +1,253 @@
+#include "AlakazamDeltaFrames.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+namespace
+{
+	const uint8 DeltaMagic[4] = { 'A', 'K', 'D', 'T' };
+
+	/** True if any row of the tile differs from the same tile of the previous frame */
+	bool TileChanged(const uint8* Data, int32 PitchBytes, const uint8* Previous, int32 PreviousPitchBytes, int32 Width, int32 Height)
+	{
+		const int32 RowBytes = Width * 4;
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			if (FMemory::Memcmp(Data + static_cast<int64>(Y) * PitchBytes, Previous + static_cast<int64>(Y) * PreviousPitchBytes, RowBytes) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void CopyTile(const uint8* Data, int32 PitchBytes, uint8* Previous, int32 PreviousPitchBytes, int32 Width, int32 Height)
+	{
+		const int32 RowBytes = Width * 4;
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			FMemory::Memcpy(Previous + static_cast<int64>(Y) * PreviousPitchBytes, Data + static_cast<int64>(Y) * PitchBytes, RowBytes);
+		}
+	}
+
+	FORCEINLINE void AppendU16(TArray64<uint8>& Out, int32 Value)
+	{
+		Out.Add(static_cast<uint8>(Value & 0xFF));
+		Out.Add(static_cast<uint8>((Value >> 8) & 0xFF));
+	}
+
+	FORCEINLINE void AppendU32(TArray64<uint8>& Out, uint32 Value)
+	{
+		AppendU16(Out, Value & 0xFFFF);
+		AppendU16(Out, Value >> 16);
+	}
+
+	FORCEINLINE int32 ReadU16(const uint8* Bytes)
+	{
+		return Bytes[0] | (Bytes[1] << 8);
+	}
+
+	FORCEINLINE uint32 ReadU32(const uint8* Bytes)
+	{
+		return static_cast<uint32>(ReadU16(Bytes)) | (static_cast<uint32>(ReadU16(Bytes + 2)) << 16);
+	}
+}
+
+bool AlakazamDelta::IsDeltaEnvelope(const uint8* Data, int64 Size)
+{
+	return Data && Size >= HeaderSize && FMemory::Memcmp(Data, DeltaMagic, 4) == 0;
+}
+
+void FAlakazamDeltaEncoder::Reset()
+{
+	Width = 0;
+	Height = 0;
+	PreviousFrame.Empty();
+	FramesSinceKeyframe = 0;
+}
+
+bool FAlakazamDeltaEncoder::EncodeDelta(const FAlakazamPixelView& Pixels, int32 Quality, EAlakazamChromaSubsampling Subsampling, bool bForceKeyframe, TArray64<uint8>& OutEnvelope)
+{
+	using namespace AlakazamDelta;
+
+	if (!Pixels.Data || Pixels.Width <= 0 || Pixels.Height <= 0 || Pixels.Width > 0xFFFF || Pixels.Height > 0xFFFF)
+	{
+		Reset();
+		return false;
+	}
+
+	// A new size invalidates every tile
+	const bool bSizeChanged = Pixels.Width != Width || Pixels.Height != Height;
+	if (bSizeChanged)
+	{
+		Width = Pixels.Width;
+		Height = Pixels.Height;
+		TilesX = FMath::DivideAndRoundUp(Width, TileSize);
+		TilesY = FMath::DivideAndRoundUp(Height, TileSize);
+		PreviousFrame.SetNumUninitialized(static_cast<int64>(Width) * Height * 4);
+	}
+	DirtyTiles.Init(false, TilesX * TilesY);
+
+	// Compared byte for byte, so no change can go unnoticed; only changed tiles are copied over
+	const int32 PreviousPitchBytes = Width * 4;
+	int32 NumDirty = 0;
+	for (int32 TileY = 0; TileY < TilesY; TileY++)
+	{
+		const int32 Y = TileY * TileSize;
+		const int32 TileHeight = FMath::Min(TileSize, Height - Y);
+		for (int32 TileX = 0; TileX < TilesX; TileX++)
+		{
+			const int32 X = TileX * TileSize;
+			const int32 TileWidth = FMath::Min(TileSize, Width - X);
+			const uint8* TileData = Pixels.Data + static_cast<int64>(Y) * Pixels.PitchBytes + X * 4;
+			uint8* PreviousData = PreviousFrame.GetData() + static_cast<int64>(Y) * PreviousPitchBytes + X * 4;
+
+			if (bSizeChanged || TileChanged(TileData, Pixels.PitchBytes, PreviousData, PreviousPitchBytes, TileWidth, TileHeight))
+			{
+				CopyTile(TileData, Pixels.PitchBytes, PreviousData, PreviousPitchBytes, TileWidth, TileHeight);
+				DirtyTiles[TileY * TilesX + TileX] = true;
+				NumDirty++;
+			}
+		}
+	}
+
+	const int32 NumTiles = TilesX * TilesY;
+	LastDirtyFraction = static_cast<float>(NumDirty) / NumTiles;
+
+	FramesSinceKeyframe++;
+	if (bSizeChanged || bForceKeyframe || FramesSinceKeyframe >= FMath::Max(1, KeyframeInterval) || LastDirtyFraction > MaxDirtyFraction)
+	{
+		FramesSinceKeyframe = 0;
+		return false;
+	}
+
+	// Merge runs of dirty tiles in each tile row into one rectangle
+	OutEnvelope.Reset();
+	OutEnvelope.Append(DeltaMagic, 4);
+	OutEnvelope.Add(Version);
+	OutEnvelope.Add(0);
+	AppendU16(OutEnvelope, 0);	// Rect count, patched below
+	AppendU16(OutEnvelope, Width);
+	AppendU16(OutEnvelope, Height);
+
+	int32 NumRects = 0;
+	for (int32 TileY = 0; TileY < TilesY; TileY++)
+	{
+		for (int32 TileX = 0; TileX < TilesX;)
+		{
+			if (!DirtyTiles[TileY * TilesX + TileX])
+			{
+				TileX++;
+				continue;
+			}
+
+			const int32 RunStart = TileX;
+			while (TileX < TilesX && DirtyTiles[TileY * TilesX + TileX])
+			{
+				TileX++;
+			}
+
+			FAlakazamPixelView Rect = Pixels;
+			const int32 X = RunStart * TileSize;
+			const int32 Y = TileY * TileSize;
+			Rect.Data = Pixels.Data + static_cast<int64>(Y) * Pixels.PitchBytes + X * 4;
+			Rect.Width = FMath::Min(TileX * TileSize, Width) - X;
+			Rect.Height = FMath::Min(TileSize, Height - Y);
+
+			if (!Encoder.Encode(Rect, Quality, Subsampling, RectJpeg) || NumRects == 0xFFFF)
+			{
+				// The previous frame is already up to date, so sending this frame as a keyframe keeps both sides in sync
+				FramesSinceKeyframe = 0;
+				return false;
+			}
+
+			AppendU16(OutEnvelope, X);
+			AppendU16(OutEnvelope, Y);
+			AppendU16(OutEnvelope, Rect.Width);
+			AppendU16(OutEnvelope, Rect.Height);
+			AppendU32(OutEnvelope, static_cast<uint32>(RectJpeg.Num()));
+			OutEnvelope.Append(RectJpeg.GetData(), RectJpeg.Num());
+			NumRects++;
+		}
+	}
+
+	OutEnvelope[6] = static_cast<uint8>(NumRects & 0xFF);
+	OutEnvelope[7] = static_cast<uint8>(NumRects >> 8);
+	return true;
+}
+
+FAlakazamDeltaCompositor::FAlakazamDeltaCompositor()
+{
+	ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+}
+
+bool FAlakazamDeltaCompositor::Decode(const uint8* Data, int64 Size, TArray<uint8>& OutBGRA, int32 ExpectedWidth, int32 ExpectedHeight)
+{
+	if (!ImageWrapperModule)
+	{
+		return false;
+	}
+	if (!ImageWrapper.IsValid())
+	{
+		ImageWrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::JPEG);
+	}
+
+	return ImageWrapper.IsValid() &&
+		ImageWrapper->SetCompressed(Data, Size) &&
+		(ExpectedWidth <= 0 || (ImageWrapper->GetWidth() == ExpectedWidth && ImageWrapper->GetHeight() == ExpectedHeight)) &&
+		ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutBGRA);
+}
+
+bool FAlakazamDeltaCompositor::Apply(const uint8* Data, int64 Size)
+{
+	using namespace AlakazamDelta;
+
+	if (!AlakazamDelta::IsDeltaEnvelope(Data, Size))
+	{
+		// Keyframe: replaces the whole canvas
+		if (!Decode(Data, Size, Frame, 0, 0))
+		{
+			Width = 0;
+			Height = 0;
+			return false;
+		}
+		Width = ImageWrapper->GetWidth();
+		Height = ImageWrapper->GetHeight();
+		return true;
+	}
+
+	if (Data[4] != Version || !HasFrame() || ReadU16(Data + 8) != Width || ReadU16(Data + 10) != Height)
+	{
+		return false;
+	}
+
+	const int32 NumRects = ReadU16(Data + 6);
+	int64 Pos = HeaderSize;
+	for (int32 RectIndex = 0; RectIndex < NumRects; RectIndex++)
+	{
+		if (Pos + RectHeaderSize > Size)
+		{
+			return false;
+		}
+
+		const int32 X = ReadU16(Data + Pos);
+		const int32 Y = ReadU16(Data + Pos + 2);
+		const int32 RectWidth = ReadU16(Data + Pos + 4);
+		const int32 RectHeight = ReadU16(Data + Pos + 6);
+		const int64 JpegSize = ReadU32(Data + Pos + 8);
+		Pos += RectHeaderSize;
+
+		if (Pos + JpegSize > Size || RectWidth == 0 || RectHeight == 0 || X + RectWidth > Width || Y + RectHeight > Height ||
+			!Decode(Data + Pos, JpegSize, RectPixels, RectWidth, RectHeight))
+		{
+			return false;
+		}
+		Pos += JpegSize;
+
+		const int32 RectRowBytes = RectWidth * 4;
+		for (int32 Row = 0; Row < RectHeight; Row++)
+		{
+			FMemory::Memcpy(Frame.GetData() + (static_cast<int64>(Y + Row) * Width + X) * 4, RectPixels.GetData() + Row * RectRowBytes, RectRowBytes);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,230 @@
+#include "AlakazamEncodePipeline.h"
+#include "AlakazamStats.h"
+#include "Async/Async.h"
+
+namespace
+{
+	// Weight of the newest sample in the rolling stage averages
+	constexpr float StatsSmoothing = 0.1f;
+
+	void Accumulate(float& Average, double Seconds)
+	{
+		const float Ms = static_cast<float>(Seconds * 1000.0);
+		Average = Average == 0.0f ? Ms : FMath::Lerp(Average, Ms, StatsSmoothing);
+	}
+}
+
+FAlakazamEncodePipeline::FAlakazamEncodePipeline(TSharedPtr<IWebSocket> InWebSocket, int32 InMaxQueueDepth)
+	: WebSocket(InWebSocket)
+	, MaxQueueDepth(FMath::Clamp(InMaxQueueDepth, 1, static_cast<int32>(MaxFramesQueued)))
+{
+}
+
+bool FAlakazamEncodePipeline::Submit(FAlakazamEncodeJob&& Job)
+{
+	if (QueueDepth.load() >= MaxQueueDepth)
+	{
+		FramesDropped++;
+		return false;
+	}
+
+	QueueDepth++;
+	Job.SubmitTime = FPlatformTime::Seconds();
+
+	// Chain on the previous job so frames are encoded and sent in order
+	TSharedRef<FAlakazamEncodePipeline, ESPMode::ThreadSafe> Self = AsShared();
+	auto Work = [Self, Job = MoveTemp(Job)]() mutable
+	{
+		Self->RunJob(Job);
+	};
+
+	if (LastTask.IsValid())
+	{
+		LastTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Work), UE::Tasks::Prerequisites(LastTask));
+	}
+	else
+	{
+		LastTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Work));
+	}
+	return true;
+}
+
+void FAlakazamEncodePipeline::Flush()
+{
+	if (LastTask.IsValid())
+	{
+		LastTask.Wait();
+		LastTask = UE::Tasks::FTask();
+	}
+	SendEncodedFrames();
+}
+
+void FAlakazamEncodePipeline::SendEncodedFrames()
+{
+	check(IsInGameThread());
+
+	FEncodedFrame Frame;
+	while (EncodedFrames.Pop(Frame))
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		const bool bSent = WebSocket.IsValid() && WebSocket->IsConnected();
+		if (bSent)
+		{
+			ALAKAZAM_SCOPE(STAT_AlakazamSendFrame);
+			WebSocket->Send(Frame.Message.GetData(), Frame.Message.Num(), true);
+			INC_DWORD_STAT_BY(STAT_AlakazamBytesSent, Frame.Message.Num());
+			TRACE_COUNTER_ADD(AlakazamBytesSent, Frame.Message.Num());
+
+			FAlakazamSentFrame SentFrame;
+			SentFrame.Sequence = Frame.Sequence;
+			SentFrame.Bytes = Frame.Message.Num();
+			SentFrame.EncodeDoneTime = Frame.EncodeDoneTime;
+			SentFrame.SendTime = FPlatformTime::Seconds();
+			SentFrames.Add(SentFrame);
+
+			if (Frame.Sequence <= 5 || Frame.Sequence % 100 == 0)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Alakazam: Sent frame %u (%lld bytes)"), Frame.Sequence, Frame.Message.Num());
+			}
+		}
+		else
+		{
+			// A delta builds on every frame before it, so one that never left means starting over from a keyframe
+			bResetDelta = true;
+		}
+
+		{
+			FScopeLock Lock(&StatsLock);
+			Accumulate(Stats.SendMs, FPlatformTime::Seconds() - StartTime);
+			if (bSent)
+			{
+				const float FrameKB = Frame.Message.Num() / 1024.0f;
+				Stats.FrameKB = Stats.FrameKB == 0.0f ? FrameKB : FMath::Lerp(Stats.FrameKB, FrameKB, StatsSmoothing);
+			}
+		}
+
+		// Hand the buffer back with its capacity; there is always room, as buffers never outnumber the queue
+		Frame.Message.Reset();
+		FreeBuffers.Push(MoveTemp(Frame.Message));
+		QueueDepth--;
+	}
+}
+
+void FAlakazamEncodePipeline::ConsumeSentFrames(TArray<FAlakazamSentFrame>& OutFrames)
+{
+	OutFrames.Append(SentFrames);
+	SentFrames.Reset();
+}
+
+FAlakazamEncodeStats FAlakazamEncodePipeline::GetStats() const
+{
+	FScopeLock Lock(&StatsLock);
+	FAlakazamEncodeStats Result = Stats;
+	Result.QueueDepth = QueueDepth.load();
+	Result.FramesDropped = FramesDropped.load();
+	return Result;
+}
+
+void FAlakazamEncodePipeline::RunJob(FAlakazamEncodeJob& Job)
+{
+	ALAKAZAM_SCOPE(STAT_AlakazamEncodeFrame);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (bResetDelta.exchange(false))
+	{
+		DeltaEncoder.Reset();
+	}
+
+	FAlakazamPixelView Pixels;
+	Pixels.Data = Job.SourceData;
+	Pixels.Width = Job.Width;
+	Pixels.Height = Job.Height;
+	Pixels.PitchBytes = Job.SourcePitchBytes;
+	Pixels.Format = EAlakazamSourceFormat::BGRA;
+	const bool bHasSource = Job.SourceData && Job.Width > 0 && Job.Height > 0;
+
+	// Delta frames hash and encode the changed tiles straight from the source
+	bool bEncodedDelta = false;
+	if (Job.bDeltaFrames && bHasSource)
+	{
+		DeltaEncoder.KeyframeInterval = Job.KeyframeInterval;
+		DeltaEncoder.MaxDirtyFraction = Job.MaxDirtyFraction;
+		bEncodedDelta = DeltaEncoder.EncodeDelta(Pixels, Job.Quality, Job.Subsampling, Job.bForceKeyframe, CompressedData);
+	}
+	else
+	{
+		DeltaEncoder.Reset();
+	}
+
+	// Convert straight from the borrowed memory (any row pitch) into reused YUV planes
+	bool bConverted = false;
+	if (!bEncodedDelta && bHasSource)
+	{
+		const int32 NumBands = Job.NumStripes > 0 ? Job.NumStripes : FAlakazamJpegEncoder::GetAutoStripeCount();
+		AlakazamColorConvert::Convert(Pixels, FAlakazamJpegEncoder::GetPlanarLayout(Job.Subsampling), Planes, NumBands);
+		bConverted = true;
+	}
+
+	// The planes hold everything the encoder needs, so the source can go back to the owner now
+	if (Job.OnSourceReleased)
+	{
+		Job.OnSourceReleased();
+	}
+
+	if (!bEncodedDelta && (!bConverted || !Encoder.EncodePlanar(Planes, Job.Quality, CompressedData, Job.NumStripes)))
+	{
+		CompressedData.Reset();
+	}
+	const double EncodeDoneTime = FPlatformTime::Seconds();
+
+	if (CompressedData.Num() == 0)
+	{
+		DeltaEncoder.Reset();
+		QueueDepth--;
+		return;
+	}
+
+	FEncodedFrame Frame;
+	Frame.Sequence = Job.Sequence;
+	Frame.EncodeDoneTime = EncodeDoneTime;
+	FreeBuffers.Pop(Frame.Message);
+
+	// Negotiated frame header goes in front of the payload; without one the payload buffer is
+	// handed over as it is and the recycled one takes its place
+	if (Job.bFrameHeader)
+	{
+		Frame.Message.Reset();
+		Job.Header.Write(Frame.Message);
+		Frame.Message.Append(CompressedData.GetData(), CompressedData.Num());
+	}
+	else
+	{
+		Swap(Frame.Message, CompressedData);
+	}
+
+	{
+		FScopeLock Lock(&StatsLock);
+		Accumulate(Stats.QueueWaitMs, StartTime - Job.SubmitTime);
+		Accumulate(Stats.EncodeMs, EncodeDoneTime - StartTime);
+		if (Job.bDeltaFrames)
+		{
+			Stats.DirtyTileFraction = FMath::Lerp(Stats.DirtyTileFraction, DeltaEncoder.GetLastDirtyFraction(), StatsSmoothing);
+			if (!bEncodedDelta)
+			{
+				Stats.KeyframesSent++;
+			}
+		}
+	}
+
+	// The socket is only touched on the game thread; the frame stays counted in the queue until sent
+	EncodedFrames.Push(MoveTemp(Frame));
+	TWeakPtr<FAlakazamEncodePipeline, ESPMode::ThreadSafe> WeakSelf = AsShared();
+	AsyncTask(ENamedThreads::GameThread, [WeakSelf]()
+	{
+		if (TSharedPtr<FAlakazamEncodePipeline, ESPMode::ThreadSafe> Self = WeakSelf.Pin())
+		{
+			Self->SendEncodedFrames();
+		}
+	});
+}
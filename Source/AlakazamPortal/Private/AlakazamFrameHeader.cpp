@@ -0,0 +1,72 @@
+#include "AlakazamFrameHeader.h"
+
+namespace
+{
+	const uint8 HeaderMagic[4] = { 'A', 'K', 'F', 'H' };
+
+	// Fields are copied as-is, which is the wire byte order on every platform the engine supports
+	static_assert(PLATFORM_LITTLE_ENDIAN, "Frame header fields are written in native byte order");
+
+	template<typename T>
+	FORCEINLINE void WriteField(uint8* Header, int32 Offset, T Value)
+	{
+		FMemory::Memcpy(Header + Offset, &Value, sizeof(T));
+	}
+
+	template<typename T>
+	FORCEINLINE T ReadField(const uint8* Header, int32 Offset)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Header + Offset, sizeof(T));
+		return Value;
+	}
+}
+
+void FAlakazamFrameHeader::Write(TArray64<uint8>& Out) const
+{
+	uint8 Header[EncodedSize];
+	FMemory::Memcpy(Header, HeaderMagic, 4);
+	Header[4] = CurrentVersion;
+	Header[5] = 0;
+	WriteField<uint16>(Header, 6, EncodedSize);
+	WriteField<uint32>(Header, 8, Sequence);
+	WriteField<uint32>(Header, 12, PromptEpoch);
+	WriteField<uint64>(Header, 16, CaptureTimeUs);
+	WriteField<float>(Header, 24, CameraLocation.X);
+	WriteField<float>(Header, 28, CameraLocation.Y);
+	WriteField<float>(Header, 32, CameraLocation.Z);
+	WriteField<float>(Header, 36, CameraRotation.Pitch);
+	WriteField<float>(Header, 40, CameraRotation.Yaw);
+	WriteField<float>(Header, 44, CameraRotation.Roll);
+	WriteField<float>(Header, 48, CameraFOV);
+	WriteField<float>(Header, 52, InferenceMs);
+	Out.Append(Header, EncodedSize);
+}
+
+int64 FAlakazamFrameHeader::Read(const uint8* Data, int64 Size, FAlakazamFrameHeader& OutHeader)
+{
+	if (!Data || Size < EncodedSize || FMemory::Memcmp(Data, HeaderMagic, 4) != 0 || Data[4] < 1)
+	{
+		return 0;
+	}
+
+	// Newer versions only append fields, so anything past the ones known here is skipped
+	const int32 HeaderSize = ReadField<uint16>(Data, 6);
+	if (HeaderSize < EncodedSize || HeaderSize > Size)
+	{
+		return 0;
+	}
+
+	OutHeader.Sequence = ReadField<uint32>(Data, 8);
+	OutHeader.PromptEpoch = ReadField<uint32>(Data, 12);
+	OutHeader.CaptureTimeUs = ReadField<uint64>(Data, 16);
+	OutHeader.CameraLocation.X = ReadField<float>(Data, 24);
+	OutHeader.CameraLocation.Y = ReadField<float>(Data, 28);
+	OutHeader.CameraLocation.Z = ReadField<float>(Data, 32);
+	OutHeader.CameraRotation.Pitch = ReadField<float>(Data, 36);
+	OutHeader.CameraRotation.Yaw = ReadField<float>(Data, 40);
+	OutHeader.CameraRotation.Roll = ReadField<float>(Data, 44);
+	OutHeader.CameraFOV = ReadField<float>(Data, 48);
+	OutHeader.InferenceMs = ReadField<float>(Data, 52);
+	return HeaderSize;
+}
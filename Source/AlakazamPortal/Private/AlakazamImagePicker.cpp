@@ -6,8 +6,145 @@
 #include "Engine/Texture2D.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
 #include "Framework/Application/SlateApplication.h"
 
+namespace
+{
+	// Files up to this size are sent for style extraction as they are, unless the controller
+	// downscales them (ReferenceImageMaxEdge). Bigger ones (typically lossless screenshots) are
+	// smaller re-encoded, and BMP is never sent as-is.
+	constexpr int64 MaxSourceFileBytes = 4 * 1024 * 1024;
+	constexpr int32 MaxSourceImageSize = 4096;
+
+	struct FDecodedImageFile
+	{
+		TArray<uint8> FileData;
+		TArray<uint8> Pixels;	// BGRA8
+		int32 Width = 0;
+		int32 Height = 0;
+		EImageFormat Format = EImageFormat::Invalid;
+	};
+
+	// Read and decode an image file. Safe on any thread once the ImageWrapper module is loaded.
+	bool DecodeImageFile(IImageWrapperModule& ImageWrapperModule, const FString& FilePath, FDecodedImageFile& Out)
+	{
+		if (FilePath.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: File path is empty"));
+			return false;
+		}
+
+		if (!FPaths::FileExists(FilePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: File not found: %s"), *FilePath);
+			return false;
+		}
+
+		// Read file data
+		TArray<uint8>& FileData = Out.FileData;
+		if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to read file: %s"), *FilePath);
+			return false;
+		}
+
+		// Determine image format from extension
+		FString Extension = FPaths::GetExtension(FilePath).ToLower();
+		EImageFormat ImageFormat = EImageFormat::Invalid;
+
+		if (Extension == TEXT("png"))
+		{
+			ImageFormat = EImageFormat::PNG;
+		}
+		else if (Extension == TEXT("jpg") || Extension == TEXT("jpeg"))
+		{
+			ImageFormat = EImageFormat::JPEG;
+		}
+		else if (Extension == TEXT("bmp"))
+		{
+			ImageFormat = EImageFormat::BMP;
+		}
+		else
+		{
+			// Try to detect from magic bytes
+			if (FileData.Num() >= 4)
+			{
+				if (FileData[0] == 0x89 && FileData[1] == 0x50 && FileData[2] == 0x4E && FileData[3] == 0x47)
+				{
+					ImageFormat = EImageFormat::PNG;
+				}
+				else if (FileData[0] == 0xFF && FileData[1] == 0xD8)
+				{
+					ImageFormat = EImageFormat::JPEG;
+				}
+				else if (FileData[0] == 0x42 && FileData[1] == 0x4D)
+				{
+					ImageFormat = EImageFormat::BMP;
+				}
+			}
+		}
+
+		if (ImageFormat == EImageFormat::Invalid)
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Unsupported image format: %s"), *Extension);
+			return false;
+		}
+
+		// Decompress image
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+
+		if (!ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to decompress image: %s"), *FilePath);
+			return false;
+		}
+
+		if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, Out.Pixels))
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to get raw image data: %s"), *FilePath);
+			return false;
+		}
+
+		Out.Width = ImageWrapper->GetWidth();
+		Out.Height = ImageWrapper->GetHeight();
+		Out.Format = ImageFormat;
+		return true;
+	}
+
+	// Game thread: turn a decoded file into a transient texture. Takes the file bytes from Image.
+	UTexture2D* CreateImageTexture(FDecodedImageFile& Image, const FString& FilePath)
+	{
+		// Create texture
+		UTexture2D* Texture = UTexture2D::CreateTransient(Image.Width, Image.Height, PF_B8G8R8A8);
+		if (!Texture)
+		{
+			UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to create texture"));
+			return nullptr;
+		}
+
+		// Copy pixel data
+		FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+		void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+		FMemory::Memcpy(TextureData, Image.Pixels.GetData(), Image.Pixels.Num());
+		Mip.BulkData.Unlock();
+
+		Texture->UpdateResource();
+
+		if ((Image.Format == EImageFormat::JPEG || Image.Format == EImageFormat::PNG) && Image.FileData.Num() <= MaxSourceFileBytes &&
+			Image.Width <= MaxSourceImageSize && Image.Height <= MaxSourceImageSize)
+		{
+			UAlakazamSourceImageData* Source = NewObject<UAlakazamSourceImageData>(Texture);
+			Source->FileData = MoveTemp(Image.FileData);
+			Texture->AddAssetUserData(Source);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("AlakazamImagePicker: Loaded image %s (%dx%d)"), *FilePath, Image.Width, Image.Height);
+		return Texture;
+	}
+}
+
 bool UAlakazamImagePicker::OpenImageFileDialog(FString& OutFilePath)
 {
 	return OpenImageFileDialogWithTitle(TEXT("Select Style Reference Image"), OutFilePath);
@@ -61,106 +198,14 @@ bool UAlakazamImagePicker::OpenImageFileDialogWithTitle(const FString& DialogTit
 
 UTexture2D* UAlakazamImagePicker::LoadImageFromFile(const FString& FilePath)
 {
-	if (FilePath.IsEmpty())
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: File path is empty"));
-		return nullptr;
-	}
-
-	if (!FPaths::FileExists(FilePath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: File not found: %s"), *FilePath);
-		return nullptr;
-	}
-
-	// Read file data
-	TArray<uint8> FileData;
-	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to read file: %s"), *FilePath);
-		return nullptr;
-	}
-
-	// Determine image format from extension
-	FString Extension = FPaths::GetExtension(FilePath).ToLower();
-	EImageFormat ImageFormat = EImageFormat::Invalid;
-
-	if (Extension == TEXT("png"))
-	{
-		ImageFormat = EImageFormat::PNG;
-	}
-	else if (Extension == TEXT("jpg") || Extension == TEXT("jpeg"))
-	{
-		ImageFormat = EImageFormat::JPEG;
-	}
-	else if (Extension == TEXT("bmp"))
-	{
-		ImageFormat = EImageFormat::BMP;
-	}
-	else
-	{
-		// Try to detect from magic bytes
-		if (FileData.Num() >= 4)
-		{
-			if (FileData[0] == 0x89 && FileData[1] == 0x50 && FileData[2] == 0x4E && FileData[3] == 0x47)
-			{
-				ImageFormat = EImageFormat::PNG;
-			}
-			else if (FileData[0] == 0xFF && FileData[1] == 0xD8)
-			{
-				ImageFormat = EImageFormat::JPEG;
-			}
-			else if (FileData[0] == 0x42 && FileData[1] == 0x4D)
-			{
-				ImageFormat = EImageFormat::BMP;
-			}
-		}
-	}
-
-	if (ImageFormat == EImageFormat::Invalid)
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Unsupported image format: %s"), *Extension);
-		return nullptr;
-	}
-
-	// Decompress image
 	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
 
-	if (!ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
+	FDecodedImageFile Image;
+	if (!DecodeImageFile(ImageWrapperModule, FilePath, Image))
 	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to decompress image: %s"), *FilePath);
 		return nullptr;
 	}
-
-	TArray<uint8> RawData;
-	if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData))
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to get raw image data: %s"), *FilePath);
-		return nullptr;
-	}
-
-	int32 Width = ImageWrapper->GetWidth();
-	int32 Height = ImageWrapper->GetHeight();
-
-	// Create texture
-	UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
-	if (!Texture)
-	{
-		UE_LOG(LogTemp, Error, TEXT("AlakazamImagePicker: Failed to create texture"));
-		return nullptr;
-	}
-
-	// Copy pixel data
-	FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
-	void* TextureData = Mip.BulkData.Lock(LOCK_READ_WRITE);
-	FMemory::Memcpy(TextureData, RawData.GetData(), RawData.Num());
-	Mip.BulkData.Unlock();
-
-	Texture->UpdateResource();
-
-	UE_LOG(LogTemp, Log, TEXT("AlakazamImagePicker: Loaded image %s (%dx%d)"), *FilePath, Width, Height);
-	return Texture;
+	return CreateImageTexture(Image, FilePath);
 }
 
 bool UAlakazamImagePicker::BrowseAndApplyStyleImage(UAlakazamController* Controller)
@@ -177,13 +222,15 @@ bool UAlakazamImagePicker::BrowseAndApplyStyleImage(UAlakazamController* Control
 		return false;
 	}
 
-	UTexture2D* Texture = LoadImageFromFile(FilePath);
-	if (!Texture)
+	UAlakazamLoadImageAsync* Load = UAlakazamLoadImageAsync::LoadImageFromFileAsync(Controller, FilePath);
+	Load->OnCompleteNative.AddWeakLambda(Controller, [Controller](UTexture2D* Texture)
 	{
-		return false;
-	}
-
-	Controller->SetStyleFromImage(Texture);
+		if (Texture)
+		{
+			Controller->SetStyleFromImage(Texture);
+		}
+	});
+	Load->Activate();
 	return true;
 }
 
@@ -200,3 +247,79 @@ TArray<FString> UAlakazamImagePicker::GetSupportedImageExtensions()
 {
 	return TArray<FString>{ TEXT("png"), TEXT("jpg"), TEXT("jpeg"), TEXT("bmp") };
 }
+
+UAlakazamLoadImageAsync* UAlakazamLoadImageAsync::LoadImageFromFileAsync(UObject* Owner, const FString& FilePath)
+{
+	UAlakazamLoadImageAsync* Action = NewObject<UAlakazamLoadImageAsync>();
+	Action->Owner = Owner;
+	Action->FilePath = FilePath;
+	return Action;
+}
+
+void UAlakazamLoadImageAsync::Activate()
+{
+	// Nothing else may reference the action while it waits for the worker (e.g. in the editor)
+	AddToRoot();
+
+	// Loaded here because modules can only be loaded on the game thread
+	IImageWrapperModule* ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	CancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+	TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled = CancelFlag.ToSharedRef();
+	TWeakObjectPtr<UAlakazamLoadImageAsync> WeakThis(this);
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [ImageWrapperModule, Path = FilePath, Cancelled, WeakThis]()
+	{
+		TSharedRef<FDecodedImageFile, ESPMode::ThreadSafe> Image = MakeShared<FDecodedImageFile, ESPMode::ThreadSafe>();
+		const bool bDecoded = !*Cancelled && DecodeImageFile(*ImageWrapperModule, Path, *Image);
+
+		AsyncTask(ENamedThreads::GameThread, [Image, bDecoded, Cancelled, WeakThis]()
+		{
+			UAlakazamLoadImageAsync* Self = WeakThis.Get();
+			if (*Cancelled || !Self)
+			{
+				return;
+			}
+			Self->Complete(bDecoded ? CreateImageTexture(*Image, Self->FilePath) : nullptr);
+		});
+	});
+}
+
+void UAlakazamLoadImageAsync::Cancel()
+{
+	if (CancelFlag.IsValid())
+	{
+		*CancelFlag = true;
+		CancelFlag.Reset();
+		RemoveFromRoot();
+	}
+
+	OnLoaded.Clear();
+	OnFailed.Clear();
+	OnCompleteNative.Clear();
+	SetReadyToDestroy();
+}
+
+void UAlakazamLoadImageAsync::Complete(UTexture2D* Texture)
+{
+	CancelFlag.Reset();
+	RemoveFromRoot();
+
+	// Whoever asked is gone (a destroyed widget, say), so there is nobody to give the result to
+	if (Owner.IsStale())
+	{
+		SetReadyToDestroy();
+		return;
+	}
+
+	if (Texture)
+	{
+		OnLoaded.Broadcast(Texture);
+	}
+	else
+	{
+		OnFailed.Broadcast(nullptr);
+	}
+	OnCompleteNative.Broadcast(Texture);
+	SetReadyToDestroy();
+}
@@ -46,6 +46,12 @@ void UAlakazamImagePickerWidget::NativeDestruct()
 		AlakazamController->OnStyleExtracted.RemoveDynamic(this, &UAlakazamImagePickerWidget::HandleStyleExtracted);
 	}
 
+	if (PendingLoad)
+	{
+		PendingLoad->Cancel();
+		PendingLoad = nullptr;
+	}
+
 	Super::NativeDestruct();
 }
 
@@ -60,7 +66,25 @@ void UAlakazamImagePickerWidget::BrowseForImage()
 
 void UAlakazamImagePickerWidget::LoadImageFromPath(const FString& FilePath)
 {
-	UTexture2D* Texture = UAlakazamImagePicker::LoadImageFromFile(FilePath);
+	// The latest pick wins
+	if (PendingLoad)
+	{
+		PendingLoad->Cancel();
+	}
+
+	PendingFilePath = FilePath;
+	PendingLoad = UAlakazamLoadImageAsync::LoadImageFromFileAsync(this, FilePath);
+	PendingLoad->OnCompleteNative.AddUObject(this, &UAlakazamImagePickerWidget::HandleImageLoaded);
+	PendingLoad->Activate();
+	SetStatusText(FString::Printf(TEXT("Loading: %s"), *FPaths::GetCleanFilename(FilePath)));
+}
+
+void UAlakazamImagePickerWidget::HandleImageLoaded(UTexture2D* Texture)
+{
+	const FString FilePath = PendingFilePath;
+	PendingLoad = nullptr;
+	PendingFilePath.Empty();
+
 	if (Texture)
 	{
 		LoadedTexture = Texture;
@@ -0,0 +1,31 @@
+#include "AlakazamImagePrompt.h"
+
+namespace
+{
+	const uint8 ImagePromptMagic[4] = { 'A', 'K', 'I', 'P' };
+
+	static_assert(PLATFORM_LITTLE_ENDIAN, "Image prompt header fields are written in native byte order");
+}
+
+bool AlakazamImagePrompt::Write(const uint8* Image, int64 ImageSize, uint32 PromptEpoch, bool bEnhance, TArray64<uint8>& Out)
+{
+	if (!Image || ImageSize <= 0 || ImageSize > MaxImageSize)
+	{
+		return false;
+	}
+
+	const uint16 Size = HeaderSize;
+	const uint32 ImageSize32 = static_cast<uint32>(ImageSize);
+
+	Out.Reset(HeaderSize + ImageSize);
+	Out.SetNumUninitialized(HeaderSize);
+	uint8* Header = Out.GetData();
+	FMemory::Memcpy(Header, ImagePromptMagic, 4);
+	Header[4] = CurrentVersion;
+	Header[5] = bEnhance ? FlagEnhance : 0;
+	FMemory::Memcpy(Header + 6, &Size, sizeof(Size));
+	FMemory::Memcpy(Header + 8, &PromptEpoch, sizeof(PromptEpoch));
+	FMemory::Memcpy(Header + 12, &ImageSize32, sizeof(ImageSize32));
+	Out.Append(Image, ImageSize);
+	return true;
+}
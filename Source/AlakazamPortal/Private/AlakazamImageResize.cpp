@@ -0,0 +1,204 @@
+#include "AlakazamImageResize.h"
+#include "AlakazamSimd.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/** Source pixels covering each destination pixel along one axis, with their weights */
+	struct FAxisTaps
+	{
+		TArray<int32> First;	// First source pixel, per destination pixel
+		TArray<int32> Offset;	// Into Weights, per destination pixel (plus one past the end)
+		TArray<float> Weights;
+	};
+
+	void BuildTaps(int32 SourceSize, int32 DestSize, FAxisTaps& Out)
+	{
+		const double Scale = static_cast<double>(SourceSize) / DestSize;
+		Out.First.SetNumUninitialized(DestSize);
+		Out.Offset.SetNumUninitialized(DestSize + 1);
+		Out.Weights.Reset(DestSize * (FMath::CeilToInt(Scale) + 1));
+
+		for (int32 Dest = 0; Dest < DestSize; Dest++)
+		{
+			const double Start = Dest * Scale;
+			const double End = FMath::Min<double>((Dest + 1) * Scale, SourceSize);
+			const int32 First = FMath::FloorToInt(Start);
+			const int32 Last = FMath::Min(SourceSize, FMath::CeilToInt(End));
+
+			Out.First[Dest] = First;
+			Out.Offset[Dest] = Out.Weights.Num();
+			for (int32 Index = First; Index < Last; Index++)
+			{
+				const double Coverage = FMath::Min<double>(Index + 1, End) - FMath::Max<double>(Index, Start);
+				Out.Weights.Add(static_cast<float>(Coverage / Scale));
+			}
+		}
+		Out.Offset[DestSize] = Out.Weights.Num();
+	}
+
+	// ---------------------------------------------------------------------
+	// One pixel (4 channels) as four floats
+	// ---------------------------------------------------------------------
+
+#if ALAKAZAM_SIMD_SSE
+	using FPixel4 = __m128;
+
+	FORCEINLINE FPixel4 PixelZero() { return _mm_setzero_ps(); }
+	FORCEINLINE FPixel4 PixelLoadFloat(const float* Src) { return _mm_loadu_ps(Src); }
+	FORCEINLINE void PixelStoreFloat(float* Dst, FPixel4 V) { _mm_storeu_ps(Dst, V); }
+	FORCEINLINE FPixel4 PixelMulAdd(FPixel4 Acc, FPixel4 V, float W) { return _mm_add_ps(Acc, _mm_mul_ps(V, _mm_set1_ps(W))); }
+
+	FORCEINLINE FPixel4 PixelLoadBytes(const uint8* Src)
+	{
+		int32 Packed;
+		FMemory::Memcpy(&Packed, Src, 4);
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(Packed), Zero), Zero);
+		return _mm_cvtepi32_ps(Wide);
+	}
+
+	FORCEINLINE void PixelStoreBytes(uint8* Dst, FPixel4 V)
+	{
+		// Rounds to nearest; the packs saturate to 0-255
+		const __m128i Ints = _mm_cvtps_epi32(V);
+		const __m128i Bytes = _mm_packus_epi16(_mm_packs_epi32(Ints, Ints), _mm_setzero_si128());
+		const int32 Packed = _mm_cvtsi128_si32(Bytes);
+		FMemory::Memcpy(Dst, &Packed, 4);
+	}
+#elif ALAKAZAM_SIMD_NEON
+	using FPixel4 = float32x4_t;
+
+	FORCEINLINE FPixel4 PixelZero() { return vdupq_n_f32(0.0f); }
+	FORCEINLINE FPixel4 PixelLoadFloat(const float* Src) { return vld1q_f32(Src); }
+	FORCEINLINE void PixelStoreFloat(float* Dst, FPixel4 V) { vst1q_f32(Dst, V); }
+	FORCEINLINE FPixel4 PixelMulAdd(FPixel4 Acc, FPixel4 V, float W) { return vmlaq_n_f32(Acc, V, W); }
+
+	FORCEINLINE FPixel4 PixelLoadBytes(const uint8* Src)
+	{
+		uint32 Packed;
+		FMemory::Memcpy(&Packed, Src, 4);
+		const uint16x8_t Wide = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(Packed)));
+		return vcvtq_f32_u32(vmovl_u16(vget_low_u16(Wide)));
+	}
+
+	FORCEINLINE void PixelStoreBytes(uint8* Dst, FPixel4 V)
+	{
+		const float32x4_t Clamped = vminq_f32(vmaxq_f32(V, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+		const uint32x4_t Ints = vcvtq_u32_f32(vaddq_f32(Clamped, vdupq_n_f32(0.5f)));
+		const uint8x8_t Bytes = vmovn_u16(vcombine_u16(vmovn_u32(Ints), vdup_n_u16(0)));
+		const uint32 Packed = vget_lane_u32(vreinterpret_u32_u8(Bytes), 0);
+		FMemory::Memcpy(Dst, &Packed, 4);
+	}
+#else
+	struct FPixel4
+	{
+		float C[4];
+	};
+
+	FORCEINLINE FPixel4 PixelZero() { return FPixel4{ { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+	FORCEINLINE FPixel4 PixelLoadFloat(const float* Src) { return FPixel4{ { Src[0], Src[1], Src[2], Src[3] } }; }
+	FORCEINLINE void PixelStoreFloat(float* Dst, FPixel4 V) { FMemory::Memcpy(Dst, V.C, sizeof(V.C)); }
+
+	FORCEINLINE FPixel4 PixelMulAdd(FPixel4 Acc, FPixel4 V, float W)
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Acc.C[Channel] += V.C[Channel] * W;
+		}
+		return Acc;
+	}
+
+	FORCEINLINE FPixel4 PixelLoadBytes(const uint8* Src) { return FPixel4{ { (float)Src[0], (float)Src[1], (float)Src[2], (float)Src[3] } }; }
+
+	FORCEINLINE void PixelStoreBytes(uint8* Dst, FPixel4 V)
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			Dst[Channel] = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(V.C[Channel]), 0, 255));
+		}
+	}
+#endif
+
+	/** Accumulator += Weight * source row, across the full source width */
+	void AccumulateRow(const uint8* SourceRow, float* Accumulator, int32 Width, float Weight)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			const FPixel4 Sum = PixelMulAdd(PixelLoadFloat(Accumulator + X * 4), PixelLoadBytes(SourceRow + X * 4), Weight);
+			PixelStoreFloat(Accumulator + X * 4, Sum);
+		}
+	}
+
+	/** Horizontal pass over an accumulated row into one destination row */
+	void ResolveRow(const float* Accumulator, uint8* DestRow, const FAxisTaps& Taps, int32 DestWidth)
+	{
+		for (int32 X = 0; X < DestWidth; X++)
+		{
+			const float* Source = Accumulator + Taps.First[X] * 4;
+			const float* Weights = Taps.Weights.GetData() + Taps.Offset[X];
+			const int32 NumTaps = Taps.Offset[X + 1] - Taps.Offset[X];
+
+			FPixel4 Sum = PixelZero();
+			for (int32 Tap = 0; Tap < NumTaps; Tap++)
+			{
+				Sum = PixelMulAdd(Sum, PixelLoadFloat(Source + Tap * 4), Weights[Tap]);
+			}
+			PixelStoreBytes(DestRow + X * 4, Sum);
+		}
+	}
+}
+
+FIntPoint AlakazamImageResize::FitWithin(int32 Width, int32 Height, int32 MaxEdge)
+{
+	const int32 LongEdge = FMath::Max(Width, Height);
+	if (MaxEdge <= 0 || LongEdge <= MaxEdge)
+	{
+		return FIntPoint(Width, Height);
+	}
+
+	const double Scale = static_cast<double>(MaxEdge) / LongEdge;
+	return FIntPoint(
+		FMath::Clamp(FMath::RoundToInt(Width * Scale), 1, MaxEdge),
+		FMath::Clamp(FMath::RoundToInt(Height * Scale), 1, MaxEdge));
+}
+
+bool AlakazamImageResize::Downscale(const FAlakazamPixelView& Source, int32 DstWidth, int32 DstHeight, TArray<uint8>& OutPixels)
+{
+	if (!Source.Data || DstWidth <= 0 || DstHeight <= 0 || DstWidth > Source.Width || DstHeight > Source.Height)
+	{
+		return false;
+	}
+
+	FAxisTaps Columns;
+	FAxisTaps Rows;
+	BuildTaps(Source.Width, DstWidth, Columns);
+	BuildTaps(Source.Height, DstHeight, Rows);
+
+	OutPixels.SetNumUninitialized(DstWidth * DstHeight * 4);
+	uint8* Dest = OutPixels.GetData();
+
+	// Each band owns a float row accumulator the width of the source
+	const int32 NumBands = FMath::Clamp(FMath::Min(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, DstHeight), 1, 32);
+	const int32 RowsPerBand = FMath::DivideAndRoundUp(DstHeight, NumBands);
+
+	ParallelFor(NumBands, [&](int32 Band)
+	{
+		TArray<float> Accumulator;
+		Accumulator.SetNumUninitialized(Source.Width * 4);
+
+		const int32 FirstRow = Band * RowsPerBand;
+		const int32 EndRow = FMath::Min(FirstRow + RowsPerBand, DstHeight);
+		for (int32 Y = FirstRow; Y < EndRow; Y++)
+		{
+			FMemory::Memzero(Accumulator.GetData(), Accumulator.Num() * sizeof(float));
+			for (int32 Tap = Rows.Offset[Y]; Tap < Rows.Offset[Y + 1]; Tap++)
+			{
+				const int32 SourceY = Rows.First[Y] + (Tap - Rows.Offset[Y]);
+				AccumulateRow(Source.Data + static_cast<int64>(SourceY) * Source.PitchBytes, Accumulator.GetData(), Source.Width, Rows.Weights[Tap]);
+			}
+			ResolveRow(Accumulator.GetData(), Dest + static_cast<int64>(Y) * DstWidth * 4, Columns, DstWidth);
+		}
+	});
+	return true;
+}
@@ -0,0 +1,256 @@
+#include "AlakazamJpegDecoder.h"
+#include "AlakazamJpegEncoder.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/** What the stripe split needs to know from the headers of a JPEG */
+	struct FJpegHeaderInfo
+	{
+		int32 Width = 0;
+		int32 Height = 0;
+		int32 McuWidth = 8;
+		int32 McuHeight = 8;
+		int32 RestartInterval = 0;
+		int64 SofOffset = 0;	// Offset of the SOF marker, to patch the height
+		int64 ScanStart = 0;	// First byte of entropy-coded data
+	};
+
+	FORCEINLINE int32 ReadWord(const uint8* Bytes)
+	{
+		return (Bytes[0] << 8) | Bytes[1];
+	}
+
+	/** Walk the marker segments up to the start of scan. Only single-scan sequential Huffman JPEGs qualify. */
+	bool ParseHeaders(const uint8* Data, int64 Size, FJpegHeaderInfo& Out)
+	{
+		if (Size < 4 || Data[0] != 0xFF || Data[1] != 0xD8)
+		{
+			return false;
+		}
+
+		int32 NumComponents = 0;
+		int32 MaxH = 1;
+		int32 MaxV = 1;
+
+		int64 Pos = 2;
+		while (Pos + 4 <= Size)
+		{
+			if (Data[Pos] != 0xFF)
+			{
+				return false;
+			}
+
+			const uint8 Marker = Data[Pos + 1];
+			if (Marker == 0xFF)
+			{
+				Pos++;	// Fill byte
+				continue;
+			}
+
+			const int32 Length = ReadWord(Data + Pos + 2);
+			if (Length < 2 || Pos + 2 + Length > Size)
+			{
+				return false;
+			}
+			const uint8* Segment = Data + Pos + 4;
+
+			if (Marker == 0xC0 || Marker == 0xC1)
+			{
+				// SOF0/SOF1: precision, height, width, components
+				if (Length < 8)
+				{
+					return false;
+				}
+				Out.SofOffset = Pos;
+				Out.Height = ReadWord(Segment + 1);
+				Out.Width = ReadWord(Segment + 3);
+				NumComponents = Segment[5];
+				if (NumComponents == 0 || Length < 8 + NumComponents * 3)
+				{
+					return false;
+				}
+				for (int32 Component = 0; Component < NumComponents; Component++)
+				{
+					const uint8 Sampling = Segment[6 + Component * 3 + 1];
+					MaxH = FMath::Max(MaxH, Sampling >> 4);
+					MaxV = FMath::Max(MaxV, Sampling & 0x0F);
+				}
+			}
+			else if (Marker >= 0xC2 && Marker <= 0xCF && Marker != 0xC4 && Marker != 0xC8 && Marker != 0xCC)
+			{
+				// Progressive, lossless or arithmetic coded
+				return false;
+			}
+			else if (Marker == 0xDD && Length >= 4)
+			{
+				Out.RestartInterval = ReadWord(Segment);
+			}
+			else if (Marker == 0xDA)
+			{
+				// The scan has to interleave every component for MCUs to line up with rows
+				if (NumComponents == 0 || Segment[0] != NumComponents)
+				{
+					return false;
+				}
+
+				// A single-component scan is never interleaved and uses 8x8 MCUs
+				if (NumComponents > 1)
+				{
+					Out.McuWidth = 8 * MaxH;
+					Out.McuHeight = 8 * MaxV;
+				}
+				Out.ScanStart = Pos + 2 + Length;
+				return Out.Width > 0 && Out.Height > 0;
+			}
+
+			Pos += 2 + Length;
+		}
+		return false;
+	}
+}
+
+FAlakazamJpegDecoder::FAlakazamJpegDecoder()
+{
+	ImageWrapperModule = &FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+}
+
+bool FAlakazamJpegDecoder::Decode(const uint8* Data, int64 Size, TArray<uint8>& OutBGRA, int32& OutWidth, int32& OutHeight, int32 MaxStripes)
+{
+	FJpegHeaderInfo Info;
+	if (!ImageWrapperModule || !Data || !ParseHeaders(Data, Size, Info))
+	{
+		return false;
+	}
+
+	// Restart intervals must cover whole MCU rows, so every segment starts at the left edge
+	const int32 McusX = FMath::DivideAndRoundUp(Info.Width, Info.McuWidth);
+	const int32 McusY = FMath::DivideAndRoundUp(Info.Height, Info.McuHeight);
+	if (Info.RestartInterval <= 0 || Info.RestartInterval % McusX != 0)
+	{
+		return false;
+	}
+	const int32 McuRowsPerSegment = Info.RestartInterval / McusX;
+
+	// Cut the entropy-coded data at RSTn markers. 0xFF00 is a stuffed data byte.
+	Segments.Reset();
+	FSegment Current;
+	Current.Start = Info.ScanStart;
+	bool bFoundEnd = false;
+	for (int64 Pos = Info.ScanStart; Pos + 1 < Size; Pos++)
+	{
+		if (Data[Pos] != 0xFF)
+		{
+			continue;
+		}
+
+		const uint8 Next = Data[Pos + 1];
+		if (Next >= 0xD0 && Next <= 0xD7)
+		{
+			Current.End = Pos;
+			Segments.Add(Current);
+			Current.Start = Pos + 2;
+			Pos++;
+		}
+		else if (Next == 0xD9)
+		{
+			Current.End = Pos;
+			Segments.Add(Current);
+			bFoundEnd = true;
+			break;
+		}
+		else if (Next == 0x00)
+		{
+			Pos++;
+		}
+	}
+
+	const int32 NumSegments = Segments.Num();
+	if (!bFoundEnd || NumSegments < 2 || NumSegments != FMath::DivideAndRoundUp(McusY, McuRowsPerSegment))
+	{
+		return false;
+	}
+
+	// Group consecutive segments into one stripe per thread
+	const int32 RequestedStripes = MaxStripes > 0 ? MaxStripes : FAlakazamJpegEncoder::GetAutoStripeCount();
+	const int32 SegmentsPerStripe = FMath::DivideAndRoundUp(NumSegments, FMath::Clamp(RequestedStripes, 1, NumSegments));
+	const int32 NumStripes = FMath::DivideAndRoundUp(NumSegments, SegmentsPerStripe);
+	if (NumStripes < 2)
+	{
+		return false;
+	}
+
+	if (Stripes.Num() < NumStripes)
+	{
+		Stripes.SetNum(NumStripes);
+	}
+
+	const int32 SegmentRows = McuRowsPerSegment * Info.McuHeight;
+	for (int32 StripeIndex = 0; StripeIndex < NumStripes; StripeIndex++)
+	{
+		FStripe& Stripe = Stripes[StripeIndex];
+		const int32 FirstSegment = StripeIndex * SegmentsPerStripe;
+		const int32 EndSegment = FMath::Min(FirstSegment + SegmentsPerStripe, NumSegments);
+
+		Stripe.FirstRow = FirstSegment * SegmentRows;
+		Stripe.NumRows = FMath::Min(Info.Height, EndSegment * SegmentRows) - Stripe.FirstRow;
+		Stripe.bDecoded = false;
+
+		// Same headers with the stripe's height, then its segments renumbered from RST0
+		Stripe.Jpeg.Reset();
+		Stripe.Jpeg.Append(Data, Info.ScanStart);
+		Stripe.Jpeg[Info.SofOffset + 5] = static_cast<uint8>(Stripe.NumRows >> 8);
+		Stripe.Jpeg[Info.SofOffset + 6] = static_cast<uint8>(Stripe.NumRows & 0xFF);
+
+		for (int32 SegmentIndex = FirstSegment; SegmentIndex < EndSegment; SegmentIndex++)
+		{
+			if (SegmentIndex > FirstSegment)
+			{
+				Stripe.Jpeg.Add(0xFF);
+				Stripe.Jpeg.Add(static_cast<uint8>(0xD0 + ((SegmentIndex - FirstSegment - 1) & 7)));
+			}
+			const FSegment& Segment = Segments[SegmentIndex];
+			Stripe.Jpeg.Append(Data + Segment.Start, Segment.End - Segment.Start);
+		}
+		Stripe.Jpeg.Add(0xFF);
+		Stripe.Jpeg.Add(0xD9);
+
+		if (!Stripe.Wrapper.IsValid())
+		{
+			Stripe.Wrapper = ImageWrapperModule->CreateImageWrapper(EImageFormat::JPEG);
+		}
+	}
+
+	const int64 RowBytes = static_cast<int64>(Info.Width) * 4;
+	OutBGRA.SetNumUninitialized(RowBytes * Info.Height);
+	uint8* OutData = OutBGRA.GetData();
+
+	ParallelFor(NumStripes, [this, OutData, RowBytes](int32 StripeIndex)
+	{
+		FStripe& Stripe = Stripes[StripeIndex];
+		if (!Stripe.Wrapper.IsValid() ||
+			!Stripe.Wrapper->SetCompressed(Stripe.Jpeg.GetData(), Stripe.Jpeg.Num()) ||
+			!Stripe.Wrapper->GetRaw(ERGBFormat::BGRA, 8, Stripe.Raw) ||
+			Stripe.Raw.Num() != RowBytes * Stripe.NumRows)
+		{
+			return;
+		}
+
+		FMemory::Memcpy(OutData + RowBytes * Stripe.FirstRow, Stripe.Raw.GetData(), Stripe.Raw.Num());
+		Stripe.bDecoded = true;
+	});
+
+	for (int32 StripeIndex = 0; StripeIndex < NumStripes; StripeIndex++)
+	{
+		if (!Stripes[StripeIndex].bDecoded)
+		{
+			return false;
+		}
+	}
+
+	OutWidth = Info.Width;
+	OutHeight = Info.Height;
+	return true;
+}
@@ -0,0 +1,837 @@
+#include "AlakazamJpegEncoder.h"
+#include "AlakazamSimd.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+	// Natural (row-major) index of each coefficient in zigzag order
+	const uint8 ZigzagToNatural[64] =
+	{
+		 0,  1,  8, 16,  9,  2,  3, 10,
+		17, 24, 32, 25, 18, 11,  4,  5,
+		12, 19, 26, 33, 40, 48, 41, 34,
+		27, 20, 13,  6,  7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36,
+		29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46,
+		53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	// ITU T.81 Annex K.1 quantisation tables (natural order)
+	const uint8 BaseQuantTables[2][64] =
+	{
+		{
+			16, 11, 10, 16,  24,  40,  51,  61,
+			12, 12, 14, 19,  26,  58,  60,  55,
+			14, 13, 16, 24,  40,  57,  69,  56,
+			14, 17, 22, 29,  51,  87,  80,  62,
+			18, 22, 37, 56,  68, 109, 103,  77,
+			24, 35, 55, 64,  81, 104, 113,  92,
+			49, 64, 78, 87, 103, 121, 120, 101,
+			72, 92, 95, 98, 112, 100, 103,  99
+		},
+		{
+			17, 18, 24, 47, 99, 99, 99, 99,
+			18, 21, 26, 66, 99, 99, 99, 99,
+			24, 26, 56, 99, 99, 99, 99, 99,
+			47, 66, 99, 99, 99, 99, 99, 99,
+			99, 99, 99, 99, 99, 99, 99, 99,
+			99, 99, 99, 99, 99, 99, 99, 99,
+			99, 99, 99, 99, 99, 99, 99, 99,
+			99, 99, 99, 99, 99, 99, 99, 99
+		}
+	};
+
+	// ITU T.81 Annex K.3 Huffman tables: code counts per length, then symbols
+	const uint8 DcLumaBits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+	const uint8 DcChromaBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+	const uint8 DcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+	const uint8 AcLumaBits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+	const uint8 AcLumaValues[162] =
+	{
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+		0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+		0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+		0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+		0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+		0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+		0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa
+	};
+
+	const uint8 AcChromaBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+	const uint8 AcChromaValues[162] =
+	{
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+		0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+		0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+		0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+		0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+		0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+		0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+		0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa
+	};
+
+	// Output scale of the AAN DCT for each row/column index
+	const float AanScale[8] = { 1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f };
+
+	/** Huffman table expanded to a code and length per symbol */
+	struct FHuffmanTable
+	{
+		const uint8* Bits = nullptr;
+		const uint8* Values = nullptr;
+		int32 NumValues = 0;
+		uint16 Code[256] = {};
+		uint8 Size[256] = {};
+
+		void Build(const uint8* InBits, const uint8* InValues, int32 InNumValues)
+		{
+			Bits = InBits;
+			Values = InValues;
+			NumValues = InNumValues;
+
+			// Canonical code assignment (T.81 Annex C)
+			uint16 NextCode = 0;
+			int32 Symbol = 0;
+			for (int32 Length = 1; Length <= 16; Length++)
+			{
+				for (int32 Index = 0; Index < Bits[Length - 1]; Index++)
+				{
+					Code[Values[Symbol]] = NextCode++;
+					Size[Values[Symbol]] = static_cast<uint8>(Length);
+					Symbol++;
+				}
+				NextCode <<= 1;
+			}
+		}
+	};
+
+	/** The four standard tables in DHT order: DC luma, AC luma, DC chroma, AC chroma */
+	struct FStandardHuffmanTables
+	{
+		FHuffmanTable Tables[4];
+
+		FStandardHuffmanTables()
+		{
+			Tables[0].Build(DcLumaBits, DcValues, UE_ARRAY_COUNT(DcValues));
+			Tables[1].Build(AcLumaBits, AcLumaValues, UE_ARRAY_COUNT(AcLumaValues));
+			Tables[2].Build(DcChromaBits, DcValues, UE_ARRAY_COUNT(DcValues));
+			Tables[3].Build(AcChromaBits, AcChromaValues, UE_ARRAY_COUNT(AcChromaValues));
+		}
+
+		static const FStandardHuffmanTables& Get()
+		{
+			static const FStandardHuffmanTables Instance;
+			return Instance;
+		}
+	};
+
+	/**
+	 * Entropy-coded segment writer with 0xFF byte stuffing.
+	 * Writes through a raw cursor into a scratch array; callers reserve room per MCU with Ensure().
+	 */
+	struct FBitWriter
+	{
+		TArray64<uint8>& Scratch;
+		uint8* Cursor;
+		uint8* End;
+		uint64 Buffer = 0;
+		int32 Count = 0;	// Pending bits in the low end of Buffer, always below 32 between calls
+
+		explicit FBitWriter(TArray64<uint8>& InScratch)
+			: Scratch(InScratch)
+			, Cursor(InScratch.GetData())
+			, End(InScratch.GetData() + InScratch.Num())
+		{
+		}
+
+		/** Make sure at least Bytes more can be written */
+		FORCEINLINE void Ensure(int64 Bytes)
+		{
+			if (End - Cursor < Bytes)
+			{
+				const int64 Used = Cursor - Scratch.GetData();
+				Scratch.SetNumUninitialized(FMath::Max(Scratch.Num() * 2, Used + Bytes));
+				Cursor = Scratch.GetData() + Used;
+				End = Scratch.GetData() + Scratch.Num();
+			}
+		}
+
+		FORCEINLINE void EmitByte(uint8 Byte)
+		{
+			*Cursor++ = Byte;
+			if (Byte == 0xFF)
+			{
+				*Cursor++ = 0;
+			}
+		}
+
+		/** Size is at most 27 bits (a Huffman code and its extra bits) */
+		FORCEINLINE void Put(uint32 Bits, int32 Size)
+		{
+			Buffer = (Buffer << Size) | Bits;
+			Count += Size;
+			if (Count >= 32)
+			{
+				Count -= 32;
+				const uint32 Word = static_cast<uint32>(Buffer >> Count);
+
+				// Store the word in one go unless one of its bytes needs stuffing
+				if ((((~Word) - 0x01010101u) & Word & 0x80808080u) == 0)
+				{
+					Cursor[0] = static_cast<uint8>(Word >> 24);
+					Cursor[1] = static_cast<uint8>(Word >> 16);
+					Cursor[2] = static_cast<uint8>(Word >> 8);
+					Cursor[3] = static_cast<uint8>(Word);
+					Cursor += 4;
+				}
+				else
+				{
+					EmitByte(static_cast<uint8>(Word >> 24));
+					EmitByte(static_cast<uint8>(Word >> 16));
+					EmitByte(static_cast<uint8>(Word >> 8));
+					EmitByte(static_cast<uint8>(Word));
+				}
+			}
+		}
+
+		/** Pad the last byte with one bits and write out everything pending */
+		void Flush()
+		{
+			Ensure(16);
+			if (Count % 8)
+			{
+				const int32 Pad = 8 - Count % 8;
+				Buffer = (Buffer << Pad) | ((1u << Pad) - 1);
+				Count += Pad;
+			}
+			while (Count > 0)
+			{
+				Count -= 8;
+				EmitByte(static_cast<uint8>(Buffer >> Count));
+			}
+		}
+
+		int64 NumBytes() const
+		{
+			return Cursor - Scratch.GetData();
+		}
+	};
+
+	// Stripes shorter than this cost more in scheduling and restart markers than they save
+	constexpr int32 MinMcuRowsPerStripe = 2;
+
+	// Worst case for one block is ~210 bytes of codes, doubled if every byte needs stuffing
+	constexpr int64 MaxBlockBytes = 512;
+
+	/** Number of bits needed for the magnitude of Value (the JPEG "category") */
+	FORCEINLINE int32 BitLength(int32 Value)
+	{
+		const uint32 Magnitude = static_cast<uint32>(Value < 0 ? -Value : Value);
+		return 32 - static_cast<int32>(FMath::CountLeadingZeros(Magnitude));
+	}
+
+	/** Magnitude bits of a coefficient, ones-complemented for negative values */
+	FORCEINLINE uint32 ExtraBits(int32 Value, int32 Length)
+	{
+		return static_cast<uint32>(Value < 0 ? Value - 1 : Value) & ((1u << Length) - 1);
+	}
+
+	/** One-dimensional float AAN DCT (after jfdctflt.c) over eight lanes, for scalars or vectors of columns */
+	template<typename T>
+	FORCEINLINE void Dct8(T* D)
+	{
+		const T Tmp0 = D[0] + D[7];
+		const T Tmp7 = D[0] - D[7];
+		const T Tmp1 = D[1] + D[6];
+		const T Tmp6 = D[1] - D[6];
+		const T Tmp2 = D[2] + D[5];
+		const T Tmp5 = D[2] - D[5];
+		const T Tmp3 = D[3] + D[4];
+		const T Tmp4 = D[3] - D[4];
+
+		// Even part
+		const T Tmp10 = Tmp0 + Tmp3;
+		const T Tmp13 = Tmp0 - Tmp3;
+		const T Tmp11 = Tmp1 + Tmp2;
+		const T Tmp12 = Tmp1 - Tmp2;
+
+		D[0] = Tmp10 + Tmp11;
+		D[4] = Tmp10 - Tmp11;
+
+		const T Z1 = (Tmp12 + Tmp13) * 0.707106781f;
+		D[2] = Tmp13 + Z1;
+		D[6] = Tmp13 - Z1;
+
+		// Odd part
+		const T Odd10 = Tmp4 + Tmp5;
+		const T Odd11 = Tmp5 + Tmp6;
+		const T Odd12 = Tmp6 + Tmp7;
+
+		const T Z5 = (Odd10 - Odd12) * 0.382683433f;
+		const T Z2 = Odd10 * 0.541196100f + Z5;
+		const T Z4 = Odd12 * 1.306562965f + Z5;
+		const T Z3 = Odd11 * 0.707106781f;
+
+		const T Z11 = Tmp7 + Z3;
+		const T Z13 = Tmp7 - Z3;
+
+		D[5] = Z13 + Z2;
+		D[3] = Z13 - Z2;
+		D[1] = Z11 + Z4;
+		D[7] = Z11 - Z4;
+	}
+
+#if ALAKAZAM_SIMD_SSE || ALAKAZAM_SIMD_NEON
+	/** Four float lanes, enough arithmetic for Dct8 */
+	struct FFloat4
+	{
+#if ALAKAZAM_SIMD_SSE
+		__m128 V;
+#else
+		float32x4_t V;
+#endif
+	};
+
+#if ALAKAZAM_SIMD_SSE
+	FORCEINLINE FFloat4 operator+(FFloat4 A, FFloat4 B) { return { _mm_add_ps(A.V, B.V) }; }
+	FORCEINLINE FFloat4 operator-(FFloat4 A, FFloat4 B) { return { _mm_sub_ps(A.V, B.V) }; }
+	FORCEINLINE FFloat4 operator*(FFloat4 A, float B) { return { _mm_mul_ps(A.V, _mm_set1_ps(B)) }; }
+	FORCEINLINE FFloat4 LoadFloat4(const float* Src) { return { _mm_load_ps(Src) }; }
+	FORCEINLINE void StoreFloat4(float* Dst, FFloat4 A) { _mm_store_ps(Dst, A.V); }
+
+	FORCEINLINE void Transpose4(FFloat4& A, FFloat4& B, FFloat4& C, FFloat4& D)
+	{
+		_MM_TRANSPOSE4_PS(A.V, B.V, C.V, D.V);
+	}
+
+	FORCEINLINE __m128i QuantizeFloat4(const float* Coefficients, const float* Divisors)
+	{
+		// Round by truncating a positively biased value, like the scalar path
+		const __m128 Scaled = _mm_add_ps(_mm_mul_ps(_mm_load_ps(Coefficients), _mm_loadu_ps(Divisors)), _mm_set1_ps(16384.5f));
+		return _mm_sub_epi32(_mm_cvttps_epi32(Scaled), _mm_set1_epi32(16384));
+	}
+
+	/** Quantise eight coefficients to 16 bits */
+	FORCEINLINE void QuantizeFloat8(const float* Coefficients, const float* Divisors, int16* Out)
+	{
+		const __m128i Packed = _mm_packs_epi32(QuantizeFloat4(Coefficients, Divisors), QuantizeFloat4(Coefficients + 4, Divisors + 4));
+		_mm_store_si128(reinterpret_cast<__m128i*>(Out), Packed);
+	}
+
+	/** Bit K set when Values[K] is non-zero */
+	FORCEINLINE uint64 NonZeroMask(const int16* Values)
+	{
+		const __m128i Zero = _mm_setzero_si128();
+		uint64 ZeroMask = 0;
+		for (int32 Index = 0; Index < 64; Index += 16)
+		{
+			const __m128i Low = _mm_cmpeq_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(Values + Index)), Zero);
+			const __m128i High = _mm_cmpeq_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(Values + Index + 8)), Zero);
+			ZeroMask |= static_cast<uint64>(_mm_movemask_epi8(_mm_packs_epi16(Low, High))) << Index;
+		}
+		return ~ZeroMask;
+	}
+
+	FORCEINLINE void LoadRow8(const uint8* Src, float* Dst)
+	{
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i Words = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src)), Zero);
+		_mm_store_ps(Dst, _mm_cvtepi32_ps(_mm_unpacklo_epi16(Words, Zero)));
+		_mm_store_ps(Dst + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(Words, Zero)));
+	}
+#else
+	FORCEINLINE FFloat4 operator+(FFloat4 A, FFloat4 B) { return { vaddq_f32(A.V, B.V) }; }
+	FORCEINLINE FFloat4 operator-(FFloat4 A, FFloat4 B) { return { vsubq_f32(A.V, B.V) }; }
+	FORCEINLINE FFloat4 operator*(FFloat4 A, float B) { return { vmulq_n_f32(A.V, B) }; }
+	FORCEINLINE FFloat4 LoadFloat4(const float* Src) { return { vld1q_f32(Src) }; }
+	FORCEINLINE void StoreFloat4(float* Dst, FFloat4 A) { vst1q_f32(Dst, A.V); }
+
+	FORCEINLINE void Transpose4(FFloat4& A, FFloat4& B, FFloat4& C, FFloat4& D)
+	{
+		const float32x4x2_t AB = vtrnq_f32(A.V, B.V);
+		const float32x4x2_t CD = vtrnq_f32(C.V, D.V);
+		A.V = vcombine_f32(vget_low_f32(AB.val[0]), vget_low_f32(CD.val[0]));
+		B.V = vcombine_f32(vget_low_f32(AB.val[1]), vget_low_f32(CD.val[1]));
+		C.V = vcombine_f32(vget_high_f32(AB.val[0]), vget_high_f32(CD.val[0]));
+		D.V = vcombine_f32(vget_high_f32(AB.val[1]), vget_high_f32(CD.val[1]));
+	}
+
+	FORCEINLINE int32x4_t QuantizeFloat4(const float* Coefficients, const float* Divisors)
+	{
+		const float32x4_t Scaled = vaddq_f32(vmulq_f32(vld1q_f32(Coefficients), vld1q_f32(Divisors)), vdupq_n_f32(16384.5f));
+		return vsubq_s32(vcvtq_s32_f32(Scaled), vdupq_n_s32(16384));
+	}
+
+	FORCEINLINE void QuantizeFloat8(const float* Coefficients, const float* Divisors, int16* Out)
+	{
+		vst1q_s16(Out, vcombine_s16(vqmovn_s32(QuantizeFloat4(Coefficients, Divisors)), vqmovn_s32(QuantizeFloat4(Coefficients + 4, Divisors + 4))));
+	}
+
+	FORCEINLINE uint64 NonZeroMask(const int16* Values)
+	{
+		// Weight each lane by its bit and add across, eight lanes at a time
+		static const uint8 LaneBits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+		const uint8x8_t Bits = vld1_u8(LaneBits);
+		uint64 Mask = 0;
+		for (int32 Index = 0; Index < 64; Index += 8)
+		{
+			const uint8x8_t NonZero = vmovn_u16(vtstq_s16(vld1q_s16(Values + Index), vld1q_s16(Values + Index)));
+			Mask |= static_cast<uint64>(vaddv_u8(vand_u8(NonZero, Bits))) << Index;
+		}
+		return Mask;
+	}
+
+	FORCEINLINE void LoadRow8(const uint8* Src, float* Dst)
+	{
+		const uint16x8_t Words = vmovl_u8(vld1_u8(Src));
+		vst1q_f32(Dst, vcvtq_f32_u32(vmovl_u16(vget_low_u16(Words))));
+		vst1q_f32(Dst + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(Words))));
+	}
+#endif
+
+	/** Transpose an 8x8 block held as left (columns 0-3) and right (columns 4-7) halves of each row */
+	FORCEINLINE void Transpose8x8(FFloat4* Left, FFloat4* Right)
+	{
+		Transpose4(Left[0], Left[1], Left[2], Left[3]);
+		Transpose4(Left[4], Left[5], Left[6], Left[7]);
+		Transpose4(Right[0], Right[1], Right[2], Right[3]);
+		Transpose4(Right[4], Right[5], Right[6], Right[7]);
+		for (int32 Index = 0; Index < 4; Index++)
+		{
+			Swap(Left[4 + Index], Right[Index]);
+		}
+	}
+#endif
+
+	/**
+	 * Forward DCT of a block of unshifted samples, in place. Output is scaled by
+	 * AanScale[row] * AanScale[col] * 8, which the quantisation divisors undo.
+	 */
+	void ForwardDct(float* Data)
+	{
+#if ALAKAZAM_SIMD_SSE || ALAKAZAM_SIMD_NEON
+		// Columns four at a time, transpose, columns again, transpose back
+		FFloat4 Left[8];
+		FFloat4 Right[8];
+		for (int32 Row = 0; Row < 8; Row++)
+		{
+			Left[Row] = LoadFloat4(Data + Row * 8);
+			Right[Row] = LoadFloat4(Data + Row * 8 + 4);
+		}
+
+		Dct8(Left);
+		Dct8(Right);
+		Transpose8x8(Left, Right);
+		Dct8(Left);
+		Dct8(Right);
+		Transpose8x8(Left, Right);
+
+		for (int32 Row = 0; Row < 8; Row++)
+		{
+			StoreFloat4(Data + Row * 8, Left[Row]);
+			StoreFloat4(Data + Row * 8 + 4, Right[Row]);
+		}
+#else
+		float Line[8];
+		for (int32 Row = 0; Row < 8; Row++)
+		{
+			Dct8(Data + Row * 8);
+		}
+		for (int32 Column = 0; Column < 8; Column++)
+		{
+			for (int32 Index = 0; Index < 8; Index++)
+			{
+				Line[Index] = Data[Index * 8 + Column];
+			}
+			Dct8(Line);
+			for (int32 Index = 0; Index < 8; Index++)
+			{
+				Data[Index * 8 + Column] = Line[Index];
+			}
+		}
+#endif
+
+		// Level shift: subtracting 128 from every sample only moves the DC term
+		Data[0] -= 128.0f * 64.0f;
+	}
+
+	FORCEINLINE void Quantize(const float* Coefficients, const float* Divisors, int16* Out)
+	{
+#if ALAKAZAM_SIMD_SSE || ALAKAZAM_SIMD_NEON
+		for (int32 Index = 0; Index < 64; Index += 8)
+		{
+			QuantizeFloat8(Coefficients + Index, Divisors + Index, Out + Index);
+		}
+#else
+		for (int32 Index = 0; Index < 64; Index++)
+		{
+			// Round to nearest, biased to keep the float-to-int conversion truncating a positive value
+			Out[Index] = static_cast<int16>(static_cast<int32>(Coefficients[Index] * Divisors[Index] + 16384.5f) - 16384);
+		}
+#endif
+	}
+
+#if !ALAKAZAM_SIMD_SSE && !ALAKAZAM_SIMD_NEON
+	FORCEINLINE uint64 NonZeroMask(const int16* Values)
+	{
+		uint64 Mask = 0;
+		for (int32 Index = 0; Index < 64; Index++)
+		{
+			Mask |= static_cast<uint64>(Values[Index] != 0) << Index;
+		}
+		return Mask;
+	}
+#endif
+
+	/** Load an 8x8 block, replicating the last row/column past the plane edge */
+	FORCEINLINE void LoadBlock(const FAlakazamPlanarImage& Image, int32 Plane, int32 X0, int32 Y0, float* Block)
+	{
+		const int32 PlaneWidth = Image.PlaneWidth[Plane];
+		const int32 PlaneHeight = Image.PlaneHeight[Plane];
+
+		if (X0 + 8 <= PlaneWidth && Y0 + 8 <= PlaneHeight)
+		{
+			for (int32 Y = 0; Y < 8; Y++)
+			{
+#if ALAKAZAM_SIMD_SSE || ALAKAZAM_SIMD_NEON
+				LoadRow8(Image.GetRow(Plane, Y0 + Y) + X0, Block + Y * 8);
+#else
+				const uint8* Row = Image.GetRow(Plane, Y0 + Y) + X0;
+				for (int32 X = 0; X < 8; X++)
+				{
+					Block[Y * 8 + X] = static_cast<float>(Row[X]);
+				}
+#endif
+			}
+			return;
+		}
+
+		for (int32 Y = 0; Y < 8; Y++)
+		{
+			const uint8* Row = Image.GetRow(Plane, FMath::Min(Y0 + Y, PlaneHeight - 1));
+			for (int32 X = 0; X < 8; X++)
+			{
+				Block[Y * 8 + X] = static_cast<float>(Row[FMath::Min(X0 + X, PlaneWidth - 1)]);
+			}
+		}
+	}
+
+	/** Transform, quantise and entropy code one block */
+	void EncodeBlock(FBitWriter& Writer, float* Block, const float* Divisors, int32& LastDc, const FHuffmanTable& DcTable, const FHuffmanTable& AcTable)
+	{
+		ForwardDct(Block);
+
+		alignas(16) int16 Quantized[64];
+		Quantize(Block, Divisors, Quantized);
+
+		// DC: difference from the previous block of the same component
+		const int32 Diff = Quantized[0] - LastDc;
+		LastDc = Quantized[0];
+
+		int32 Length = BitLength(Diff);
+		Writer.Put((static_cast<uint32>(DcTable.Code[Length]) << Length) | ExtraBits(Diff, Length), DcTable.Size[Length] + Length);
+
+		// AC: reorder to zigzag, then walk only the non-zero coefficients
+		alignas(16) int16 Zigzag[64];
+		for (int32 K = 0; K < 64; K++)
+		{
+			Zigzag[K] = Quantized[ZigzagToNatural[K]];
+		}
+		uint64 NonZero = NonZeroMask(Zigzag) & ~1ull;
+
+		int32 LastK = 0;
+		while (NonZero)
+		{
+			const int32 K = static_cast<int32>(FMath::CountTrailingZeros64(NonZero));
+			NonZero &= NonZero - 1;
+
+			int32 Run = K - LastK - 1;
+			while (Run > 15)
+			{
+				Writer.Put(AcTable.Code[0xF0], AcTable.Size[0xF0]);
+				Run -= 16;
+			}
+
+			const int32 Value = Zigzag[K];
+			Length = BitLength(Value);
+			const int32 Symbol = (Run << 4) | Length;
+			Writer.Put((static_cast<uint32>(AcTable.Code[Symbol]) << Length) | ExtraBits(Value, Length), AcTable.Size[Symbol] + Length);
+			LastK = K;
+		}
+
+		if (LastK != 63)
+		{
+			Writer.Put(AcTable.Code[0x00], AcTable.Size[0x00]);
+		}
+	}
+
+	void WriteMarker(TArray64<uint8>& Out, uint8 Marker)
+	{
+		Out.Add(0xFF);
+		Out.Add(Marker);
+	}
+
+	void WriteWord(TArray64<uint8>& Out, int32 Value)
+	{
+		Out.Add(static_cast<uint8>(Value >> 8));
+		Out.Add(static_cast<uint8>(Value & 0xFF));
+	}
+}
+
+FAlakazamJpegEncoder::FAlakazamJpegEncoder()
+{
+	FMemory::Memzero(QuantTables);
+	FMemory::Memzero(Divisors);
+}
+
+EAlakazamPixelLayout FAlakazamJpegEncoder::GetPlanarLayout(EAlakazamChromaSubsampling Subsampling)
+{
+	switch (Subsampling)
+	{
+	case EAlakazamChromaSubsampling::Yuv444: return EAlakazamPixelLayout::YUV444;
+	case EAlakazamChromaSubsampling::Yuv422: return EAlakazamPixelLayout::YUV422;
+	default: return EAlakazamPixelLayout::YUV420;
+	}
+}
+
+int32 FAlakazamJpegEncoder::GetAutoStripeCount()
+{
+	// Worker threads plus the calling thread, which helps out inside ParallelFor
+	return FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+}
+
+bool FAlakazamJpegEncoder::Encode(const FAlakazamPixelView& Pixels, int32 Quality, EAlakazamChromaSubsampling Subsampling, TArray64<uint8>& OutJpeg, int32 NumStripes)
+{
+	if (!Pixels.Data || Pixels.Width <= 0 || Pixels.Height <= 0)
+	{
+		return false;
+	}
+
+	const int32 NumBands = NumStripes > 0 ? NumStripes : GetAutoStripeCount();
+	AlakazamColorConvert::Convert(Pixels, GetPlanarLayout(Subsampling), Planes, NumBands);
+	return EncodePlanar(Planes, Quality, OutJpeg, NumStripes);
+}
+
+bool FAlakazamJpegEncoder::EncodePlanar(const FAlakazamPlanarImage& Image, int32 Quality, TArray64<uint8>& OutJpeg, int32 NumStripes)
+{
+	// Baseline JPEG stores dimensions in 16 bits
+	if (Image.Width <= 0 || Image.Height <= 0 || Image.Width > 65535 || Image.Height > 65535)
+	{
+		return false;
+	}
+
+	const FFrameLayout Frame = GetFrameLayout(Image);
+	if (Frame.NumComponents == 0)
+	{
+		return false;
+	}
+
+	UpdateQuantTables(Quality);
+
+	// Split into stripes of whole MCU rows. The restart interval is one stripe's worth of MCUs,
+	// so every stripe starts with fresh DC predictors and can be coded independently.
+	const int32 RequestedStripes = NumStripes > 0 ? NumStripes : GetAutoStripeCount();
+	const int32 MaxStripes = FMath::Max(1, Frame.McusY / MinMcuRowsPerStripe);
+	int32 McuRowsPerStripe = FMath::DivideAndRoundUp(Frame.McusY, FMath::Clamp(RequestedStripes, 1, MaxStripes));
+	McuRowsPerStripe = FMath::Max(1, FMath::Min(McuRowsPerStripe, 65535 / Frame.McusX));	// DRI is 16 bits
+	const int32 ActualStripes = FMath::DivideAndRoundUp(Frame.McusY, McuRowsPerStripe);
+	const int32 RestartInterval = ActualStripes > 1 ? McuRowsPerStripe * Frame.McusX : 0;
+
+	if (StripeScratch.Num() < ActualStripes)
+	{
+		StripeScratch.SetNum(ActualStripes);
+	}
+	StripeBytes.SetNumUninitialized(ActualStripes);
+
+	auto EncodeStripe = [this, &Image, &Frame, McuRowsPerStripe](int32 Stripe)
+	{
+		const int32 FirstRow = Stripe * McuRowsPerStripe;
+		const int32 NumRows = FMath::Min(McuRowsPerStripe, Frame.McusY - FirstRow);
+		StripeBytes[Stripe] = EncodeMcuRows(Image, Frame, FirstRow, NumRows, StripeScratch[Stripe]);
+	};
+
+	if (ActualStripes > 1)
+	{
+		ParallelFor(ActualStripes, EncodeStripe);
+	}
+	else
+	{
+		EncodeStripe(0);
+	}
+
+	// Reset without freeing, so a reused output array stops allocating once it has grown
+	OutJpeg.Reset();
+	WriteHeaders(Image, Frame, RestartInterval, OutJpeg);
+	for (int32 Stripe = 0; Stripe < ActualStripes; Stripe++)
+	{
+		if (Stripe > 0)
+		{
+			WriteMarker(OutJpeg, static_cast<uint8>(0xD0 + ((Stripe - 1) & 7)));	// RSTn, numbered modulo 8
+		}
+		OutJpeg.Append(StripeScratch[Stripe].GetData(), StripeBytes[Stripe]);
+	}
+	WriteMarker(OutJpeg, 0xD9);	// EOI
+	return true;
+}
+
+void FAlakazamJpegEncoder::UpdateQuantTables(int32 Quality)
+{
+	Quality = FMath::Clamp(Quality, 1, 100);
+	if (Quality == CachedQuality)
+	{
+		return;
+	}
+	CachedQuality = Quality;
+
+	// Same quality scaling as libjpeg, so JpegQuality keeps its familiar meaning
+	const int32 Scale = Quality < 50 ? 5000 / Quality : 200 - Quality * 2;
+
+	for (int32 Table = 0; Table < 2; Table++)
+	{
+		for (int32 K = 0; K < 64; K++)
+		{
+			const int32 Natural = ZigzagToNatural[K];
+			const int32 Value = FMath::Clamp((BaseQuantTables[Table][Natural] * Scale + 50) / 100, 1, 255);
+			QuantTables[Table][K] = static_cast<uint8>(Value);
+			Divisors[Table][Natural] = 1.0f / (Value * AanScale[Natural / 8] * AanScale[Natural % 8] * 8.0f);
+		}
+	}
+}
+
+FAlakazamJpegEncoder::FFrameLayout FAlakazamJpegEncoder::GetFrameLayout(const FAlakazamPlanarImage& Image) const
+{
+	FFrameLayout Frame;
+	switch (Image.Layout)
+	{
+	case EAlakazamPixelLayout::Luma:	Frame.NumComponents = 1; break;
+	case EAlakazamPixelLayout::YUV444:	Frame.NumComponents = 3; break;
+	case EAlakazamPixelLayout::YUV422:	Frame.NumComponents = 3; Frame.MaxH = 2; break;
+	case EAlakazamPixelLayout::YUV420:	Frame.NumComponents = 3; Frame.MaxH = 2; Frame.MaxV = 2; break;
+	default:							return Frame;	// Packed layouts can't be encoded directly
+	}
+
+	Frame.McusX = FMath::DivideAndRoundUp(Image.Width, 8 * Frame.MaxH);
+	Frame.McusY = FMath::DivideAndRoundUp(Image.Height, 8 * Frame.MaxV);
+	return Frame;
+}
+
+void FAlakazamJpegEncoder::WriteHeaders(const FAlakazamPlanarImage& Image, const FFrameLayout& Frame, int32 RestartInterval, TArray64<uint8>& Out) const
+{
+	const int32 NumTables = Frame.NumComponents > 1 ? 2 : 1;
+
+	WriteMarker(Out, 0xD8);	// SOI
+
+	// APP0 / JFIF 1.01, no density, no thumbnail
+	static const uint8 Jfif[] = { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 };
+	WriteMarker(Out, 0xE0);
+	WriteWord(Out, 2 + UE_ARRAY_COUNT(Jfif));
+	Out.Append(Jfif, UE_ARRAY_COUNT(Jfif));
+
+	// DQT
+	WriteMarker(Out, 0xDB);
+	WriteWord(Out, 2 + NumTables * 65);
+	for (int32 Table = 0; Table < NumTables; Table++)
+	{
+		Out.Add(static_cast<uint8>(Table));
+		Out.Append(QuantTables[Table], 64);
+	}
+
+	// SOF0: luma carries the sampling factors, chroma is always 1x1
+	WriteMarker(Out, 0xC0);
+	WriteWord(Out, 8 + Frame.NumComponents * 3);
+	Out.Add(8);
+	WriteWord(Out, Image.Height);
+	WriteWord(Out, Image.Width);
+	Out.Add(static_cast<uint8>(Frame.NumComponents));
+	for (int32 Component = 0; Component < Frame.NumComponents; Component++)
+	{
+		Out.Add(static_cast<uint8>(Component + 1));
+		Out.Add(static_cast<uint8>(Component == 0 ? (Frame.MaxH << 4) | Frame.MaxV : 0x11));
+		Out.Add(static_cast<uint8>(Component == 0 ? 0 : 1));
+	}
+
+	// DHT
+	const FStandardHuffmanTables& Huffman = FStandardHuffmanTables::Get();
+	int32 DhtLength = 2;
+	for (int32 Table = 0; Table < NumTables * 2; Table++)
+	{
+		DhtLength += 17 + Huffman.Tables[Table].NumValues;
+	}
+	WriteMarker(Out, 0xC4);
+	WriteWord(Out, DhtLength);
+	for (int32 Table = 0; Table < NumTables * 2; Table++)
+	{
+		const FHuffmanTable& Entry = Huffman.Tables[Table];
+		Out.Add(static_cast<uint8>(((Table & 1) << 4) | (Table >> 1)));	// Class (DC/AC) and destination
+		Out.Append(Entry.Bits, 16);
+		Out.Append(Entry.Values, Entry.NumValues);
+	}
+
+	// DRI
+	if (RestartInterval > 0)
+	{
+		WriteMarker(Out, 0xDD);
+		WriteWord(Out, 4);
+		WriteWord(Out, RestartInterval);
+	}
+
+	// SOS
+	WriteMarker(Out, 0xDA);
+	WriteWord(Out, 6 + Frame.NumComponents * 2);
+	Out.Add(static_cast<uint8>(Frame.NumComponents));
+	for (int32 Component = 0; Component < Frame.NumComponents; Component++)
+	{
+		Out.Add(static_cast<uint8>(Component + 1));
+		Out.Add(static_cast<uint8>(Component == 0 ? 0x00 : 0x11));
+	}
+	Out.Add(0);		// Spectral selection start
+	Out.Add(63);	// Spectral selection end
+	Out.Add(0);		// Successive approximation
+}
+
+int64 FAlakazamJpegEncoder::EncodeMcuRows(const FAlakazamPlanarImage& Image, const FFrameLayout& Frame, int32 FirstMcuRow, int32 NumMcuRows, TArray64<uint8>& Scratch) const
+{
+	const FStandardHuffmanTables& Huffman = FStandardHuffmanTables::Get();
+	const int64 MaxMcuBytes = (Frame.MaxH * Frame.MaxV + Frame.NumComponents - 1) * MaxBlockBytes;
+
+	FBitWriter Writer(Scratch);
+	int32 LastDc[3] = { 0, 0, 0 };
+	alignas(16) float Block[64];
+
+	for (int32 McuY = FirstMcuRow; McuY < FirstMcuRow + NumMcuRows; McuY++)
+	{
+		for (int32 McuX = 0; McuX < Frame.McusX; McuX++)
+		{
+			Writer.Ensure(MaxMcuBytes);
+
+			// Luma blocks of the MCU in raster order
+			for (int32 BlockY = 0; BlockY < Frame.MaxV; BlockY++)
+			{
+				for (int32 BlockX = 0; BlockX < Frame.MaxH; BlockX++)
+				{
+					LoadBlock(Image, 0, (McuX * Frame.MaxH + BlockX) * 8, (McuY * Frame.MaxV + BlockY) * 8, Block);
+					EncodeBlock(Writer, Block, Divisors[0], LastDc[0], Huffman.Tables[0], Huffman.Tables[1]);
+				}
+			}
+
+			// One block each of Cb and Cr
+			for (int32 Component = 1; Component < Frame.NumComponents; Component++)
+			{
+				LoadBlock(Image, Component, McuX * 8, McuY * 8, Block);
+				EncodeBlock(Writer, Block, Divisors[1], LastDc[Component], Huffman.Tables[2], Huffman.Tables[3]);
+			}
+		}
+	}
+
+	Writer.Flush();
+	return Writer.NumBytes();
+}
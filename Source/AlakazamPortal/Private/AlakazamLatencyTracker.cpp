@@ -0,0 +1,245 @@
+#include "AlakazamLatencyTracker.h"
+#include "AlakazamEncodePipeline.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// Frames remembered while waiting for their reply; far more than can be in flight
+	constexpr int32 MaxTrackedFrames = 128;
+
+	const TCHAR* StageNames[] = { TEXT("readback"), TEXT("copy"), TEXT("encode"), TEXT("send"), TEXT("server_round_trip"), TEXT("decode"), TEXT("upload"), TEXT("total"), TEXT("prompt_switch") };
+
+	float SortedPercentile(const TArray<float>& Sorted, float Fraction)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.0f;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+}
+
+FAlakazamLatencyTracker::FAlakazamLatencyTracker()
+{
+	Reset();
+}
+
+void FAlakazamLatencyTracker::Reset()
+{
+	Frames.Reset();
+	Frames.SetNum(MaxTrackedFrames);
+
+	for (FStageSamples& Samples : Stages)
+	{
+		Samples.Recent.Reset(RecentSamples);
+		Samples.NextRecent = 0;
+		Samples.Histogram.Reset();
+		Samples.Histogram.SetNumZeroed(HistogramBuckets);
+		Samples.Count = 0;
+		Samples.SumMs = 0.0;
+		Samples.MaxMs = 0.0f;
+	}
+
+	PendingPromptEpoch = 0;
+	PromptChangeTime = 0.0;
+	SessionStart = FPlatformTime::Seconds();
+}
+
+FAlakazamLatencyTracker::FFrameTimes* FAlakazamLatencyTracker::FindFrame(uint32 Sequence)
+{
+	FFrameTimes& Frame = Frames[Sequence % MaxTrackedFrames];
+	return Frame.Sequence == Sequence ? &Frame : nullptr;
+}
+
+void FAlakazamLatencyTracker::AddSample(EStage Stage, double StartTime, double EndTime)
+{
+	if (StartTime <= 0.0 || EndTime < StartTime)
+	{
+		return;
+	}
+
+	const float Ms = static_cast<float>((EndTime - StartTime) * 1000.0);
+	FStageSamples& Samples = Stages[static_cast<int32>(Stage)];
+
+	if (Samples.Recent.Num() < RecentSamples)
+	{
+		Samples.Recent.Add(Ms);
+	}
+	else
+	{
+		Samples.Recent[Samples.NextRecent] = Ms;
+	}
+	Samples.NextRecent = (Samples.NextRecent + 1) % RecentSamples;
+
+	Samples.Histogram[FMath::Min(static_cast<int32>(Ms), HistogramBuckets - 1)]++;
+	Samples.Count++;
+	Samples.SumMs += Ms;
+	Samples.MaxMs = FMath::Max(Samples.MaxMs, Ms);
+}
+
+void FAlakazamLatencyTracker::OnCaptureIssued(uint32 Sequence, double Time)
+{
+	FFrameTimes& Frame = Frames[Sequence % MaxTrackedFrames];
+	Frame = FFrameTimes();
+	Frame.Sequence = Sequence;
+	Frame.CaptureIssued = Time;
+}
+
+void FAlakazamLatencyTracker::OnReadbackReady(uint32 Sequence, double Time)
+{
+	if (FFrameTimes* Frame = FindFrame(Sequence))
+	{
+		Frame->ReadbackReady = Time;
+		AddSample(EStage::Readback, Frame->CaptureIssued, Time);
+	}
+}
+
+void FAlakazamLatencyTracker::OnMapped(uint32 Sequence, double Time)
+{
+	if (FFrameTimes* Frame = FindFrame(Sequence))
+	{
+		Frame->Mapped = Time;
+		AddSample(EStage::Copy, Frame->ReadbackReady, Time);
+	}
+}
+
+void FAlakazamLatencyTracker::OnSent(const FAlakazamSentFrame& SentFrame)
+{
+	if (FFrameTimes* Frame = FindFrame(SentFrame.Sequence))
+	{
+		Frame->Sent = SentFrame.SendTime;
+		AddSample(EStage::Encode, Frame->Mapped, SentFrame.EncodeDoneTime);
+		AddSample(EStage::Send, SentFrame.EncodeDoneTime, SentFrame.SendTime);
+	}
+}
+
+void FAlakazamLatencyTracker::OnReplyShown(uint32 Sequence, double FirstByteTime, double DecodedTime, double UploadedTime)
+{
+	AddSample(EStage::Decode, FirstByteTime, DecodedTime);
+	AddSample(EStage::Upload, DecodedTime, UploadedTime);
+
+	if (Sequence == 0)
+	{
+		return;
+	}
+	if (FFrameTimes* Frame = FindFrame(Sequence))
+	{
+		AddSample(EStage::ServerRoundTrip, Frame->Sent, FirstByteTime);
+		AddSample(EStage::Total, Frame->CaptureIssued, UploadedTime);
+		Frame->Sequence = 0;
+	}
+}
+
+void FAlakazamLatencyTracker::OnPromptChanged(uint32 Epoch, double Time)
+{
+	// A change superseded before it was ever shown is not measured; only the latest counts
+	PendingPromptEpoch = Epoch;
+	PromptChangeTime = Time;
+}
+
+void FAlakazamLatencyTracker::OnPromptShown(uint32 PromptEpoch, double Time)
+{
+	if (PendingPromptEpoch != 0 && PromptEpoch >= PendingPromptEpoch)
+	{
+		AddSample(EStage::PromptSwitch, PromptChangeTime, Time);
+		PendingPromptEpoch = 0;
+	}
+}
+
+bool FAlakazamLatencyTracker::HasSamples() const
+{
+	for (const FStageSamples& Samples : Stages)
+	{
+		if (Samples.Count > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+FAlakazamLatencyStats FAlakazamLatencyTracker::GetStats() const
+{
+	FAlakazamLatencyPercentiles Percentiles[NumStages];
+	TArray<float> Sorted;
+	for (int32 Stage = 0; Stage < NumStages; Stage++)
+	{
+		Sorted = Stages[Stage].Recent;
+		Sorted.Sort();
+		Percentiles[Stage].P50Ms = SortedPercentile(Sorted, 0.50f);
+		Percentiles[Stage].P95Ms = SortedPercentile(Sorted, 0.95f);
+		Percentiles[Stage].P99Ms = SortedPercentile(Sorted, 0.99f);
+	}
+
+	FAlakazamLatencyStats Stats;
+	Stats.Readback = Percentiles[static_cast<int32>(EStage::Readback)];
+	Stats.Copy = Percentiles[static_cast<int32>(EStage::Copy)];
+	Stats.Encode = Percentiles[static_cast<int32>(EStage::Encode)];
+	Stats.Send = Percentiles[static_cast<int32>(EStage::Send)];
+	Stats.ServerRoundTrip = Percentiles[static_cast<int32>(EStage::ServerRoundTrip)];
+	Stats.Decode = Percentiles[static_cast<int32>(EStage::Decode)];
+	Stats.Upload = Percentiles[static_cast<int32>(EStage::Upload)];
+	Stats.Total = Percentiles[static_cast<int32>(EStage::Total)];
+	Stats.PromptSwitch = Percentiles[static_cast<int32>(EStage::PromptSwitch)];
+	return Stats;
+}
+
+float FAlakazamLatencyTracker::HistogramPercentile(const FStageSamples& Samples, float Fraction)
+{
+	if (Samples.Count == 0)
+	{
+		return 0.0f;
+	}
+
+	// Bucket upper edge, capped at the slowest sample actually seen
+	const int64 Target = FMath::Max<int64>(1, static_cast<int64>(FMath::CeilToDouble(Fraction * Samples.Count)));
+	int64 Seen = 0;
+	for (int32 Bucket = 0; Bucket < HistogramBuckets; Bucket++)
+	{
+		Seen += Samples.Histogram[Bucket];
+		if (Seen >= Target)
+		{
+			return FMath::Min(static_cast<float>(Bucket + 1), Samples.MaxMs);
+		}
+	}
+	return Samples.MaxMs;
+}
+
+FString FAlakazamLatencyTracker::WriteSessionSummary(const FString& SessionId, int32 FramesSent, int32 FramesReceived) const
+{
+	TSharedPtr<FJsonObject> Summary = MakeShareable(new FJsonObject);
+	Summary->SetStringField(TEXT("session_id"), SessionId);
+	Summary->SetStringField(TEXT("ended"), FDateTime::UtcNow().ToIso8601());
+	Summary->SetNumberField(TEXT("duration_seconds"), FPlatformTime::Seconds() - SessionStart);
+	Summary->SetNumberField(TEXT("frames_sent"), FramesSent);
+	Summary->SetNumberField(TEXT("frames_received"), FramesReceived);
+
+	TSharedPtr<FJsonObject> StagesObject = MakeShareable(new FJsonObject);
+	for (int32 Stage = 0; Stage < NumStages; Stage++)
+	{
+		const FStageSamples& Samples = Stages[Stage];
+
+		TSharedPtr<FJsonObject> StageObject = MakeShareable(new FJsonObject);
+		StageObject->SetNumberField(TEXT("samples"), static_cast<double>(Samples.Count));
+		StageObject->SetNumberField(TEXT("mean_ms"), Samples.Count > 0 ? Samples.SumMs / Samples.Count : 0.0);
+		StageObject->SetNumberField(TEXT("p50_ms"), HistogramPercentile(Samples, 0.50f));
+		StageObject->SetNumberField(TEXT("p95_ms"), HistogramPercentile(Samples, 0.95f));
+		StageObject->SetNumberField(TEXT("p99_ms"), HistogramPercentile(Samples, 0.99f));
+		StageObject->SetNumberField(TEXT("max_ms"), Samples.MaxMs);
+		StagesObject->SetObjectField(StageNames[Stage], StageObject);
+	}
+	Summary->SetObjectField(TEXT("stages"), StagesObject);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Summary.ToSharedRef(), Writer);
+
+	const FString FileName = FString::Printf(TEXT("AlakazamSession-%s.json"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	const FString Path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Alakazam"), FileName);
+	return FFileHelper::SaveStringToFile(Json, *Path) ? Path : FString();
+}
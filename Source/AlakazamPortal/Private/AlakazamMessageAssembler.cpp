@@ -0,0 +1,54 @@
+#include "AlakazamMessageAssembler.h"
+
+void FAlakazamMessageAssembler::Reserve(int64 Bytes)
+{
+	Buffer.Reserve(static_cast<int32>(FMath::Min<int64>(Bytes, MAX_int32)));
+}
+
+bool FAlakazamMessageAssembler::Add(const uint8* Data, int64 Size, int64 BytesRemaining, const uint8*& OutData, int64& OutSize)
+{
+	if (bComplete)
+	{
+		Buffer.Reset();	// Keeps the allocation
+		bComplete = false;
+	}
+
+	if (Buffer.Num() == 0)
+	{
+		if (Size == 0)
+		{
+			return false;
+		}
+
+		// Unfragmented message: no copy
+		if (BytesRemaining == 0)
+		{
+			OutData = Data;
+			OutSize = Size;
+			return true;
+		}
+
+		// The first fragment tells the whole size, so the rest never regrows the buffer
+		Reserve(Size + BytesRemaining);
+	}
+
+	if (Size > 0)
+	{
+		Buffer.Append(Data, static_cast<int32>(Size));
+	}
+	if (BytesRemaining > 0)
+	{
+		return false;
+	}
+
+	bComplete = true;
+	OutData = Buffer.GetData();
+	OutSize = Buffer.Num();
+	return true;
+}
+
+void FAlakazamMessageAssembler::Reset()
+{
+	Buffer.Reset();
+	bComplete = false;
+}
@@ -1,5 +1,6 @@
 #include "AlakazamPortalModule.h"
 #include "AlakazamSettings.h"
+#include "AlakazamStyleCache.h"
 
 #if WITH_EDITOR
 #include "AlakazamSetupWizard.h"
@@ -121,6 +122,8 @@ void FAlakazamPortalModule::ShutdownModule()
 {
 	UE_LOG(LogTemp, Log, TEXT("Alakazam Portal: Module shutdown"));
 
+	FAlakazamStyleCache::Get().Flush();
+
 #if WITH_EDITOR
 	// Clean up ticker if still running
 	if (GSetupWizardTickerHandle.IsValid())
@@ -0,0 +1,25 @@
+#include "AlakazamPromptDebounce.h"
+
+bool FAlakazamPromptDebounce::OnChange(double Now, double Window)
+{
+	if (bHasSent && Now - LastSendTime < Window)
+	{
+		bPending = true;
+		return false;
+	}
+	return true;
+}
+
+void FAlakazamPromptDebounce::OnSent(double Now)
+{
+	LastSendTime = Now;
+	bHasSent = true;
+	bPending = false;
+}
+
+void FAlakazamPromptDebounce::Reset()
+{
+	LastSendTime = 0.0;
+	bHasSent = false;
+	bPending = false;
+}
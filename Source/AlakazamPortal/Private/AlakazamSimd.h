@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Instruction sets the hand-written kernels of the capture path may use, chosen at compile time
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#define ALAKAZAM_SIMD_NEON 1
+	#include <arm_neon.h>
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#define ALAKAZAM_SIMD_SSE 1
+	#include <emmintrin.h>
+	#if defined(PLATFORM_ALWAYS_HAS_SSE4_1) && PLATFORM_ALWAYS_HAS_SSE4_1
+		#define ALAKAZAM_SIMD_SSSE3 1
+		#include <tmmintrin.h>
+	#endif
+	#if defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2
+		#define ALAKAZAM_SIMD_AVX2 1
+		#include <immintrin.h>
+	#endif
+#endif
+
+#ifndef ALAKAZAM_SIMD_NEON
+	#define ALAKAZAM_SIMD_NEON 0
+#endif
+#ifndef ALAKAZAM_SIMD_SSE
+	#define ALAKAZAM_SIMD_SSE 0
+#endif
+#ifndef ALAKAZAM_SIMD_SSSE3
+	#define ALAKAZAM_SIMD_SSSE3 0
+#endif
+#ifndef ALAKAZAM_SIMD_AVX2
+	#define ALAKAZAM_SIMD_AVX2 0
+#endif
@@ -0,0 +1,23 @@
+#include "AlakazamStats.h"
+
+UE_TRACE_CHANNEL_DEFINE(AlakazamChannel);
+
+DEFINE_STAT(STAT_AlakazamCaptureAndSend);
+DEFINE_STAT(STAT_AlakazamProcessReadback);
+DEFINE_STAT(STAT_AlakazamEncodeFrame);
+DEFINE_STAT(STAT_AlakazamSendFrame);
+DEFINE_STAT(STAT_AlakazamReceiveMessage);
+DEFINE_STAT(STAT_AlakazamProcessReceivedFrame);
+DEFINE_STAT(STAT_AlakazamDecodeFrame);
+DEFINE_STAT(STAT_AlakazamUploadFrame);
+DEFINE_STAT(STAT_AlakazamJsonMessage);
+
+DEFINE_STAT(STAT_AlakazamBytesSent);
+DEFINE_STAT(STAT_AlakazamBytesReceived);
+DEFINE_STAT(STAT_AlakazamEncodeQueueDepth);
+DEFINE_STAT(STAT_AlakazamFramesInFlight);
+
+TRACE_DECLARE_INT_COUNTER(AlakazamBytesSent, TEXT("Alakazam/BytesSent"));
+TRACE_DECLARE_INT_COUNTER(AlakazamBytesReceived, TEXT("Alakazam/BytesReceived"));
+TRACE_DECLARE_INT_COUNTER(AlakazamEncodeQueueDepth, TEXT("Alakazam/EncodeQueueDepth"));
+TRACE_DECLARE_INT_COUNTER(AlakazamFramesInFlight, TEXT("Alakazam/FramesInFlight"));
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+// Insights channel for the streaming hot paths: -trace=default,Alakazam
+UE_TRACE_CHANNEL_EXTERN(AlakazamChannel);
+
+// "stat Alakazam"
+DECLARE_STATS_GROUP(TEXT("Alakazam"), STATGROUP_Alakazam, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Capture and send"), STAT_AlakazamCaptureAndSend, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process readback"), STAT_AlakazamProcessReadback, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Encode frame"), STAT_AlakazamEncodeFrame, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Send frame"), STAT_AlakazamSendFrame, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive message"), STAT_AlakazamReceiveMessage, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process received frame"), STAT_AlakazamProcessReceivedFrame, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode frame"), STAT_AlakazamDecodeFrame, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Upload frame"), STAT_AlakazamUploadFrame, STATGROUP_Alakazam, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("JSON message"), STAT_AlakazamJsonMessage, STATGROUP_Alakazam, );
+
+// Bytes per engine frame, cleared every frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes sent"), STAT_AlakazamBytesSent, STATGROUP_Alakazam, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes received"), STAT_AlakazamBytesReceived, STATGROUP_Alakazam, );
+
+// Queue depths, set every tick
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Encode queue depth"), STAT_AlakazamEncodeQueueDepth, STATGROUP_Alakazam, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frames in flight"), STAT_AlakazamFramesInFlight, STATGROUP_Alakazam, );
+
+// Counter tracks in Insights; the byte counters are running totals, so their slope is the bandwidth
+TRACE_DECLARE_INT_COUNTER_EXTERN(AlakazamBytesSent);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AlakazamBytesReceived);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AlakazamEncodeQueueDepth);
+TRACE_DECLARE_INT_COUNTER_EXTERN(AlakazamFramesInFlight);
+
+/**
+ * CPU scope on the Alakazam trace channel plus the matching cycle stat. The trace scope stays in
+ * builds without stats, so Insights captures of Test builds still show the streaming work.
+ */
+#define ALAKAZAM_SCOPE(Stat) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, AlakazamChannel); \
+	SCOPE_CYCLE_COUNTER(Stat)
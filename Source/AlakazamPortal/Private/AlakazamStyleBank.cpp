@@ -0,0 +1,6 @@
+#include "AlakazamStyleBank.h"
+
+const FAlakazamStyleBankEntry* UAlakazamStyleBank::FindStyle(FName Id) const
+{
+	return Styles.FindByPredicate([Id](const FAlakazamStyleBankEntry& Entry) { return Entry.Id == Id; });
+}
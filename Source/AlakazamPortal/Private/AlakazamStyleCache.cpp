@@ -0,0 +1,201 @@
+#include "AlakazamStyleCache.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	constexpr int32 CacheVersion = 1;
+
+	// Rough per-entry bookkeeping in the index file on top of the key and prompt
+	constexpr int64 EntryOverheadBytes = 64;
+}
+
+FAlakazamStyleCache& FAlakazamStyleCache::Get()
+{
+	static FAlakazamStyleCache Instance(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Alakazam"), TEXT("StyleCache.json")));
+	return Instance;
+}
+
+FAlakazamStyleCache::FAlakazamStyleCache(const FString& IndexPath)
+	: Path(IndexPath)
+{
+}
+
+FString FAlakazamStyleCache::MakeKey(const uint8* Data, int64 Size, bool bEnhance)
+{
+	FSHA1 Sha;
+	Sha.Update(Data, Size);
+	Sha.Final();
+
+	uint8 Digest[FSHA1::DigestSize];
+	Sha.GetHash(Digest);
+	return BytesToHex(Digest, FSHA1::DigestSize) + (bEnhance ? TEXT("-e") : TEXT("-r"));
+}
+
+int64 FAlakazamStyleCache::EntryBytes(const FString& Key, const FEntry& Entry)
+{
+	return Key.Len() + Entry.Prompt.Len() + EntryOverheadBytes;
+}
+
+bool FAlakazamStyleCache::Find(const FString& Key, FString& OutPrompt)
+{
+	Load();
+
+	FEntry* Entry = Entries.Find(Key);
+	if (!Entry)
+	{
+		return false;
+	}
+
+	OutPrompt = Entry->Prompt;
+	if (Entry->LastUse != UseCounter)
+	{
+		Entry->LastUse = ++UseCounter;
+		bDirty = true;
+	}
+	return true;
+}
+
+void FAlakazamStyleCache::Add(const FString& Key, const FString& ExtractedPrompt, int64 MaxBytes)
+{
+	if (Key.IsEmpty() || ExtractedPrompt.IsEmpty())
+	{
+		return;
+	}
+	Load();
+
+	if (const FEntry* Existing = Entries.Find(Key))
+	{
+		TotalBytes -= EntryBytes(Key, *Existing);
+	}
+	FEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.Prompt = ExtractedPrompt;
+	Entry.LastUse = ++UseCounter;
+	TotalBytes += EntryBytes(Key, Entry);
+
+	// Evict the least recently used entries; the one just added always survives
+	while (TotalBytes > MaxBytes && Entries.Num() > 1)
+	{
+		const FString* Oldest = nullptr;
+		uint64 OldestUse = MAX_uint64;
+		for (const TPair<FString, FEntry>& Pair : Entries)
+		{
+			if (Pair.Value.LastUse < OldestUse)
+			{
+				Oldest = &Pair.Key;
+				OldestUse = Pair.Value.LastUse;
+			}
+		}
+
+		const FString OldestKey = *Oldest;
+		TotalBytes -= EntryBytes(OldestKey, Entries[OldestKey]);
+		Entries.Remove(OldestKey);
+	}
+
+	Save();
+}
+
+void FAlakazamStyleCache::Flush()
+{
+	if (bDirty)
+	{
+		Save();
+	}
+}
+
+void FAlakazamStyleCache::Clear()
+{
+	Entries.Reset();
+	TotalBytes = 0;
+	UseCounter = 0;
+	bLoaded = true;
+	bDirty = false;
+	IFileManager::Get().Delete(*Path, false, false, true);
+}
+
+void FAlakazamStyleCache::Load()
+{
+	if (bLoaded)
+	{
+		return;
+	}
+	bLoaded = true;
+
+	FString Json;
+	if (!FFileHelper::LoadFileToString(Json, *Path))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || Root->GetIntegerField(TEXT("version")) != CacheVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Ignoring unreadable style cache %s"), *Path);
+		return;
+	}
+
+	// Stored oldest first, so the recency order is rebuilt from the file order
+	const TArray<TSharedPtr<FJsonValue>>* EntryValues;
+	if (Root->TryGetArrayField(TEXT("entries"), EntryValues))
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *EntryValues)
+		{
+			const TSharedPtr<FJsonObject>* EntryObject;
+			FString Key;
+			FEntry Entry;
+			if (Value->TryGetObject(EntryObject)
+				&& (*EntryObject)->TryGetStringField(TEXT("key"), Key)
+				&& (*EntryObject)->TryGetStringField(TEXT("prompt"), Entry.Prompt)
+				&& !Entries.Contains(Key))
+			{
+				Entry.LastUse = ++UseCounter;
+				TotalBytes += EntryBytes(Key, Entry);
+				Entries.Add(Key, MoveTemp(Entry));
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Alakazam: Loaded %d cached style prompts"), Entries.Num());
+}
+
+void FAlakazamStyleCache::Save()
+{
+	bDirty = false;
+
+	TArray<const TPair<FString, FEntry>*> Sorted;
+	Sorted.Reserve(Entries.Num());
+	for (const TPair<FString, FEntry>& Pair : Entries)
+	{
+		Sorted.Add(&Pair);
+	}
+	Sorted.Sort([](const TPair<FString, FEntry>& A, const TPair<FString, FEntry>& B) { return A.Value.LastUse < B.Value.LastUse; });
+
+	TArray<TSharedPtr<FJsonValue>> EntryValues;
+	EntryValues.Reserve(Sorted.Num());
+	for (const TPair<FString, FEntry>* Pair : Sorted)
+	{
+		TSharedPtr<FJsonObject> EntryObject = MakeShareable(new FJsonObject);
+		EntryObject->SetStringField(TEXT("key"), Pair->Key);
+		EntryObject->SetStringField(TEXT("prompt"), Pair->Value.Prompt);
+		EntryValues.Add(MakeShareable(new FJsonValueObject(EntryObject)));
+	}
+
+	TSharedPtr<FJsonObject> Root = MakeShareable(new FJsonObject);
+	Root->SetNumberField(TEXT("version"), CacheVersion);
+	Root->SetArrayField(TEXT("entries"), EntryValues);
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root.ToSharedRef(), Writer);
+
+	if (!FFileHelper::SaveStringToFile(Json, *Path))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Alakazam: Failed to write style cache %s"), *Path);
+	}
+}
@@ -0,0 +1,234 @@
+#include "AlakazamColorConvert.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	constexpr EAlakazamPixelLayout AllLayouts[] = {
+		EAlakazamPixelLayout::Luma, EAlakazamPixelLayout::RGB24, EAlakazamPixelLayout::YUV444,
+		EAlakazamPixelLayout::YUV422, EAlakazamPixelLayout::YUV420, EAlakazamPixelLayout::NV12 };
+
+	// Around every vector width (4, 8, 16, 32 pixels) and its tails, plus odd heights for the chroma pairing
+	constexpr int32 TestWidths[] = { 1, 2, 3, 5, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 257 };
+	constexpr int32 TestHeights[] = { 1, 2, 3, 5 };
+
+	/** Puts the widest kernels back however the test ends */
+	struct FKernelSetScope
+	{
+		~FKernelSetScope()
+		{
+			const TArray<EAlakazamKernelSet> KernelSets = AlakazamColorConvert::GetAvailableKernelSets();
+			AlakazamColorConvert::SetMaxKernelSet(KernelSets.Last());
+		}
+	};
+
+	/** Random pixels with padding at the end of each row, so the pitch is exercised */
+	FAlakazamPixelView MakeSource(int32 Width, int32 Height, EAlakazamSourceFormat Format, FRandomStream& Random, TArray<uint8>& OutPixels)
+	{
+		const int32 PitchBytes = Width * 4 + 12;
+		OutPixels.SetNumUninitialized(PitchBytes * Height);
+		for (uint8& Byte : OutPixels)
+		{
+			Byte = static_cast<uint8>(Random.RandRange(0, 255));
+		}
+
+		FAlakazamPixelView View;
+		View.Data = OutPixels.GetData();
+		View.Width = Width;
+		View.Height = Height;
+		View.PitchBytes = PitchBytes;
+		View.Format = Format;
+		return View;
+	}
+
+	void SourceRgb(const FAlakazamPixelView& View, int32 X, int32 Y, double& R, double& G, double& B)
+	{
+		const uint8* Pixel = View.Data + static_cast<int64>(Y) * View.PitchBytes + X * 4;
+		const bool bBgra = View.Format == EAlakazamSourceFormat::BGRA;
+		R = Pixel[bBgra ? 2 : 0];
+		G = Pixel[1];
+		B = Pixel[bBgra ? 0 : 2];
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamColorConvertReferenceTest, "Alakazam.ColorConvert.ScalarMatchesBT601",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamColorConvertReferenceTest::RunTest(const FString& Parameters)
+{
+	FKernelSetScope KernelSetScope;
+	AlakazamColorConvert::SetMaxKernelSet(EAlakazamKernelSet::Scalar);
+
+	FRandomStream Random(5);
+	TArray<uint8> Pixels;
+	FAlakazamPlanarImage Image;
+	int32 Failures = 0;
+
+	for (const EAlakazamSourceFormat Format : { EAlakazamSourceFormat::BGRA, EAlakazamSourceFormat::RGBA })
+	{
+		const FAlakazamPixelView View = MakeSource(33, 5, Format, Random, Pixels);
+		for (const EAlakazamPixelLayout Layout : AllLayouts)
+		{
+			AlakazamColorConvert::Convert(View, Layout, Image);
+
+			for (int32 Y = 0; Y < View.Height; Y++)
+			{
+				for (int32 X = 0; X < View.Width; X++)
+				{
+					double R, G, B;
+					SourceRgb(View, X, Y, R, G, B);
+					if (Layout == EAlakazamPixelLayout::RGB24)
+					{
+						const uint8* Out = Image.GetRow(0, Y) + X * 3;
+						Failures += (Out[0] != R || Out[1] != G || Out[2] != B) ? 1 : 0;
+						continue;
+					}
+					const double Luma = 0.299 * R + 0.587 * G + 0.114 * B;
+					Failures += FMath::Abs(Image.GetRow(0, Y)[X] - Luma) > 1.0 ? 1 : 0;
+				}
+			}
+
+			if (Layout == EAlakazamPixelLayout::Luma || Layout == EAlakazamPixelLayout::RGB24)
+			{
+				continue;
+			}
+
+			// Chroma of the block average; blocks past the right or bottom edge repeat the last pixel
+			const int32 StepX = Layout == EAlakazamPixelLayout::YUV444 ? 1 : 2;
+			const int32 StepY = (Layout == EAlakazamPixelLayout::YUV420 || Layout == EAlakazamPixelLayout::NV12) ? 2 : 1;
+			for (int32 ChromaY = 0; ChromaY * StepY < View.Height; ChromaY++)
+			{
+				for (int32 ChromaX = 0; ChromaX * StepX < View.Width; ChromaX++)
+				{
+					double R = 0.0, G = 0.0, B = 0.0;
+					for (int32 DY = 0; DY < StepY; DY++)
+					{
+						for (int32 DX = 0; DX < StepX; DX++)
+						{
+							double PR, PG, PB;
+							SourceRgb(View, FMath::Min(ChromaX * StepX + DX, View.Width - 1), FMath::Min(ChromaY * StepY + DY, View.Height - 1), PR, PG, PB);
+							R += PR;
+							G += PG;
+							B += PB;
+						}
+					}
+					const double Count = StepX * StepY;
+					R /= Count;
+					G /= Count;
+					B /= Count;
+					const double U = -0.168736 * R - 0.331264 * G + 0.5 * B + 128.0;
+					const double V = 0.5 * R - 0.418688 * G - 0.081312 * B + 128.0;
+
+					const bool bInterleaved = Layout == EAlakazamPixelLayout::NV12;
+					const uint8 OutU = bInterleaved ? Image.GetRow(1, ChromaY)[ChromaX * 2] : Image.GetRow(1, ChromaY)[ChromaX];
+					const uint8 OutV = bInterleaved ? Image.GetRow(1, ChromaY)[ChromaX * 2 + 1] : Image.GetRow(2, ChromaY)[ChromaX];
+					Failures += (FMath::Abs(OutU - U) > 1.0 || FMath::Abs(OutV - V) > 1.0) ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	TestEqual(TEXT("Samples more than 1 off the floating point BT.601 reference"), Failures, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamColorConvertKernelsTest, "Alakazam.ColorConvert.KernelsMatchScalar",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamColorConvertKernelsTest::RunTest(const FString& Parameters)
+{
+	FKernelSetScope KernelSetScope;
+	const TArray<EAlakazamKernelSet> KernelSets = AlakazamColorConvert::GetAvailableKernelSets();
+	AddInfo(FString::Printf(TEXT("Kernels compiled in: %s"), AlakazamColorConvert::GetKernelName()));
+	if (KernelSets.Num() < 2)
+	{
+		AddInfo(TEXT("No SIMD kernels in this build; nothing to compare"));
+	}
+
+	FRandomStream Random(7);
+	TArray<uint8> Pixels;
+	FAlakazamPlanarImage Reference;
+	FAlakazamPlanarImage Image;
+
+	for (const int32 Width : TestWidths)
+	{
+		for (const int32 Height : TestHeights)
+		{
+			for (const EAlakazamSourceFormat Format : { EAlakazamSourceFormat::BGRA, EAlakazamSourceFormat::RGBA })
+			{
+				const FAlakazamPixelView View = MakeSource(Width, Height, Format, Random, Pixels);
+				for (const EAlakazamPixelLayout Layout : AllLayouts)
+				{
+					AlakazamColorConvert::SetMaxKernelSet(EAlakazamKernelSet::Scalar);
+					AlakazamColorConvert::Convert(View, Layout, Reference);
+
+					for (int32 SetIndex = 1; SetIndex < KernelSets.Num(); SetIndex++)
+					{
+						AlakazamColorConvert::SetMaxKernelSet(KernelSets[SetIndex]);
+
+						// Banded conversion must not change the result either
+						AlakazamColorConvert::Convert(View, Layout, Image, SetIndex == KernelSets.Num() - 1 ? 3 : 1);
+
+						for (int32 Plane = 0; Plane < Reference.NumPlanes; Plane++)
+						{
+							if (FMemory::Memcmp(Reference.Planes[Plane].GetData(), Image.Planes[Plane].GetData(), Reference.Planes[Plane].Num()) != 0)
+							{
+								AddError(FString::Printf(TEXT("%s differs from scalar: %dx%d, %s source, layout %d, plane %d"),
+									AlakazamColorConvert::GetKernelSetName(KernelSets[SetIndex]), Width, Height,
+									Format == EAlakazamSourceFormat::BGRA ? TEXT("BGRA") : TEXT("RGBA"), static_cast<int32>(Layout), Plane));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamColorConvertBenchmark, "Alakazam.ColorConvert.Benchmark",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAlakazamColorConvertBenchmark::RunTest(const FString& Parameters)
+{
+	FKernelSetScope KernelSetScope;
+	constexpr int32 Iterations = 20;
+	const FIntPoint Resolutions[] = { FIntPoint(1280, 720), FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+
+	FRandomStream Random(11);
+	TArray<uint8> Pixels;
+	FAlakazamPlanarImage Image;
+
+	for (const FIntPoint& Resolution : Resolutions)
+	{
+		const FAlakazamPixelView View = MakeSource(Resolution.X, Resolution.Y, EAlakazamSourceFormat::BGRA, Random, Pixels);
+		for (const EAlakazamPixelLayout Layout : AllLayouts)
+		{
+			double ScalarMs = 0.0;
+			for (const EAlakazamKernelSet KernelSet : AlakazamColorConvert::GetAvailableKernelSets())
+			{
+				AlakazamColorConvert::SetMaxKernelSet(KernelSet);
+				AlakazamColorConvert::Convert(View, Layout, Image);	// Warm up and allocate
+
+				const double Start = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+				{
+					AlakazamColorConvert::Convert(View, Layout, Image);
+				}
+				const double Ms = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+				if (KernelSet == EAlakazamKernelSet::Scalar)
+				{
+					ScalarMs = Ms;
+				}
+
+				AddInfo(FString::Printf(TEXT("%dx%d layout %d, %s: %.2f ms (%.1fx scalar)"),
+					Resolution.X, Resolution.Y, static_cast<int32>(Layout), AlakazamColorConvert::GetKernelSetName(KernelSet), Ms, Ms > 0.0 ? ScalarMs / Ms : 0.0));
+			}
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include "AlakazamDeltaFrames.h"
+#include "AlakazamTestImages.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Not a multiple of the tile size either way, so the edge tiles are partial
+	constexpr int32 FrameWidth = 200;
+	constexpr int32 FrameHeight = 130;
+	constexpr int32 Quality = 95;
+
+	// Smooth gradients, so JPEG error stays small and any large difference is a compositing bug
+	void MakeGradient(TArray<uint8>& OutPixels)
+	{
+		OutPixels.SetNumUninitialized(FrameWidth * FrameHeight * 4);
+		for (int32 Y = 0; Y < FrameHeight; Y++)
+		{
+			for (int32 X = 0; X < FrameWidth; X++)
+			{
+				uint8* Pixel = OutPixels.GetData() + (Y * FrameWidth + X) * 4;
+				Pixel[0] = static_cast<uint8>(X * 255 / (FrameWidth - 1));
+				Pixel[1] = static_cast<uint8>(Y * 255 / (FrameHeight - 1));
+				Pixel[2] = static_cast<uint8>((X + Y) * 255 / (FrameWidth + FrameHeight - 2));
+				Pixel[3] = 255;
+			}
+		}
+	}
+
+	int32 MaxDifference(const TArray<uint8>& A, const TArray<uint8>& B)
+	{
+		int32 MaxDiff = 0;
+		for (int32 Index = 0; Index < A.Num(); Index++)
+		{
+			// Alpha is not coded
+			if ((Index & 3) != 3)
+			{
+				MaxDiff = FMath::Max(MaxDiff, FMath::Abs(A[Index] - B[Index]));
+			}
+		}
+		return MaxDiff;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamDeltaRoundTripTest, "Alakazam.DeltaFrames.RoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamDeltaRoundTripTest::RunTest(const FString& Parameters)
+{
+	TArray<uint8> Pixels;
+	MakeGradient(Pixels);
+	const FAlakazamPixelView View = AlakazamTestImages::MakeView(Pixels, FrameWidth, FrameHeight);
+
+	FAlakazamDeltaEncoder Encoder;
+	Encoder.KeyframeInterval = 100;
+	FAlakazamDeltaCompositor Compositor;
+	FAlakazamJpegEncoder KeyframeEncoder;
+	TArray64<uint8> Message;
+
+	TestFalse(TEXT("First frame is a keyframe"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, false, Message));
+	TestTrue(TEXT("Keyframe encodes"), KeyframeEncoder.Encode(View, Quality, EAlakazamChromaSubsampling::Yuv444, Message));
+	TestTrue(TEXT("Keyframe applies"), Compositor.Apply(Message.GetData(), Message.Num()));
+	TestTrue(TEXT("Keyframe matches the source"), MaxDifference(Compositor.GetFrame(), Pixels) <= 8);
+
+	// A sharp-edged block inside one tile
+	for (int32 Y = 70; Y < 80; Y++)
+	{
+		for (int32 X = 70; X < 80; X++)
+		{
+			uint8* Pixel = Pixels.GetData() + (Y * FrameWidth + X) * 4;
+			Pixel[0] = 255 - Pixel[0];
+			Pixel[1] = 40;
+		}
+	}
+	const TArray<uint8> BeforeDelta = Compositor.GetFrame();
+	TestTrue(TEXT("Small change is a delta"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, false, Message));
+	TestEqual(TEXT("Only the changed tile is dirty"), Encoder.GetLastDirtyFraction(), 1.0f / 12.0f, 0.001f);
+	TestTrue(TEXT("Delta applies"), Compositor.Apply(Message.GetData(), Message.Num()));
+	TestTrue(TEXT("Composited frame matches the source"), MaxDifference(Compositor.GetFrame(), Pixels) <= 24);
+
+	bool bOutsideUntouched = true;
+	for (int32 Y = 0; Y < FrameHeight; Y++)
+	{
+		for (int32 X = 0; X < FrameWidth; X++)
+		{
+			const bool bInTile = X >= AlakazamDelta::TileSize && X < AlakazamDelta::TileSize * 2 && Y >= AlakazamDelta::TileSize && Y < AlakazamDelta::TileSize * 2;
+			const int32 Offset = (Y * FrameWidth + X) * 4;
+			if (!bInTile && FMemory::Memcmp(Compositor.GetFrame().GetData() + Offset, BeforeDelta.GetData() + Offset, 4) != 0)
+			{
+				bOutsideUntouched = false;
+			}
+		}
+	}
+	TestTrue(TEXT("Tiles outside the delta are untouched"), bOutsideUntouched);
+
+	// Nothing changed: an envelope without rectangles
+	TestTrue(TEXT("Static frame is a delta"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, false, Message));
+	TestEqual(TEXT("Static frame has no rectangles"), static_cast<int32>(Message.Num()), AlakazamDelta::HeaderSize);
+	TestTrue(TEXT("Empty delta applies"), Compositor.Apply(Message.GetData(), Message.Num()));
+
+	// One bit in the last pixel of a partial edge tile
+	Pixels[(FrameHeight * FrameWidth - 1) * 4 + 2] ^= 1;
+	TestTrue(TEXT("Single bit change is a delta"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, false, Message));
+	TestEqual(TEXT("Single bit change marks its tile dirty"), Encoder.GetLastDirtyFraction(), 1.0f / 12.0f, 0.001f);
+	TestTrue(TEXT("Edge tile delta applies"), Compositor.Apply(Message.GetData(), Message.Num()));
+
+	// Same-lane swaps leave plain pixel sums unchanged, but not the pixels
+	uint8* Row = Pixels.GetData() + 10 * FrameWidth * 4;
+	Swap(Row[0], Row[16]);
+	Swap(Row[1], Row[17]);
+	TestTrue(TEXT("Swapped pixels are a delta"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, false, Message));
+	TestTrue(TEXT("Swapped pixels are noticed"), Encoder.GetLastDirtyFraction() > 0.0f);
+
+	TestFalse(TEXT("Forced keyframe"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv444, true, Message));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamDeltaRejectTest, "Alakazam.DeltaFrames.RejectsBadEnvelopes",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamDeltaRejectTest::RunTest(const FString& Parameters)
+{
+	TArray<uint8> Pixels;
+	MakeGradient(Pixels);
+	const FAlakazamPixelView View = AlakazamTestImages::MakeView(Pixels, FrameWidth, FrameHeight);
+
+	FAlakazamDeltaEncoder Encoder;
+	TArray64<uint8> Keyframe;
+	TArray64<uint8> Delta;
+	FAlakazamJpegEncoder KeyframeEncoder;
+	Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv420, false, Delta);
+	KeyframeEncoder.Encode(View, Quality, EAlakazamChromaSubsampling::Yuv420, Keyframe);
+	Pixels[0] ^= 0xFF;
+	if (!TestTrue(TEXT("Changed frame is a delta"), Encoder.EncodeDelta(View, Quality, EAlakazamChromaSubsampling::Yuv420, false, Delta)))
+	{
+		return false;
+	}
+	TestTrue(TEXT("Delta is recognised"), AlakazamDelta::IsDeltaEnvelope(Delta.GetData(), Delta.Num()));
+	TestFalse(TEXT("Keyframe is not a delta"), AlakazamDelta::IsDeltaEnvelope(Keyframe.GetData(), Keyframe.Num()));
+
+	FAlakazamDeltaCompositor Compositor;
+	TestFalse(TEXT("Delta without a keyframe is rejected"), Compositor.Apply(Delta.GetData(), Delta.Num()));
+
+	Compositor.Apply(Keyframe.GetData(), Keyframe.Num());
+	TestFalse(TEXT("Truncated delta is rejected"), Compositor.Apply(Delta.GetData(), Delta.Num() - 1));
+
+	TArray64<uint8> WrongSize = Delta;
+	WrongSize[8] ^= 1;
+	TestFalse(TEXT("Delta for another frame size is rejected"), Compositor.Apply(WrongSize.GetData(), WrongSize.Num()));
+
+	TArray64<uint8> WrongVersion = Delta;
+	WrongVersion[4] = AlakazamDelta::Version + 1;
+	TestFalse(TEXT("Delta of an unknown version is rejected"), Compositor.Apply(WrongVersion.GetData(), WrongVersion.Num()));
+
+	TestTrue(TEXT("Intact delta still applies"), Compositor.Apply(Delta.GetData(), Delta.Num()));
+	return true;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "AlakazamFrameHeader.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	FAlakazamFrameHeader MakeTestHeader()
+	{
+		FAlakazamFrameHeader Header;
+		Header.Sequence = 0x01020304;
+		Header.PromptEpoch = 7;
+		Header.CaptureTimeUs = 0x0102030405060708ull;
+		Header.CameraLocation = FVector3f(1.5f, -250.0f, 1000.25f);
+		Header.CameraRotation = FRotator3f(-10.0f, 90.5f, 0.125f);
+		Header.CameraFOV = 75.0f;
+		Header.InferenceMs = 12.5f;
+		return Header;
+	}
+
+	void WriteU16(TArray64<uint8>& Data, int32 Offset, uint16 Value)
+	{
+		Data[Offset] = static_cast<uint8>(Value & 0xFF);
+		Data[Offset + 1] = static_cast<uint8>(Value >> 8);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamFrameHeaderRoundTripTest, "Alakazam.FrameHeader.RoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamFrameHeaderRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FAlakazamFrameHeader Header = MakeTestHeader();
+	TArray64<uint8> Message;
+	Header.Write(Message);
+	TestEqual(TEXT("Encoded size"), static_cast<int32>(Message.Num()), FAlakazamFrameHeader::EncodedSize);
+
+	// Wire format: magic, version, little-endian fields at fixed offsets
+	TestTrue(TEXT("Magic"), Message[0] == 'A' && Message[1] == 'K' && Message[2] == 'F' && Message[3] == 'H');
+	TestEqual(TEXT("Version"), static_cast<int32>(Message[4]), static_cast<int32>(FAlakazamFrameHeader::CurrentVersion));
+	TestEqual(TEXT("Header size low byte"), static_cast<int32>(Message[6]), FAlakazamFrameHeader::EncodedSize);
+	TestTrue(TEXT("Sequence is little endian"), Message[8] == 0x04 && Message[9] == 0x03 && Message[10] == 0x02 && Message[11] == 0x01);
+	TestTrue(TEXT("Capture time is little endian"), Message[16] == 0x08 && Message[23] == 0x01);
+
+	const uint8 Payload[3] = { 0xFF, 0xD8, 0xFF };
+	Message.Append(Payload, sizeof(Payload));
+
+	FAlakazamFrameHeader Parsed;
+	const int64 PayloadOffset = FAlakazamFrameHeader::Read(Message.GetData(), Message.Num(), Parsed);
+	TestEqual(TEXT("Payload follows the header"), PayloadOffset, static_cast<int64>(FAlakazamFrameHeader::EncodedSize));
+	TestEqual(TEXT("Sequence"), static_cast<int64>(Parsed.Sequence), static_cast<int64>(Header.Sequence));
+	TestEqual(TEXT("Prompt epoch"), static_cast<int64>(Parsed.PromptEpoch), static_cast<int64>(Header.PromptEpoch));
+	TestTrue(TEXT("Capture time"), Parsed.CaptureTimeUs == Header.CaptureTimeUs);
+	TestTrue(TEXT("Camera location"), Parsed.CameraLocation == Header.CameraLocation);
+	TestTrue(TEXT("Camera rotation"), Parsed.CameraRotation == Header.CameraRotation);
+	TestEqual(TEXT("Camera FOV"), Parsed.CameraFOV, Header.CameraFOV);
+	TestEqual(TEXT("Inference time"), Parsed.InferenceMs, Header.InferenceMs);
+
+	// A header with nothing after it is still a header
+	FAlakazamFrameHeader HeaderOnly;
+	TestEqual(TEXT("Header without payload"), FAlakazamFrameHeader::Read(Message.GetData(), FAlakazamFrameHeader::EncodedSize, HeaderOnly), static_cast<int64>(FAlakazamFrameHeader::EncodedSize));
+
+	TestTrue(TEXT("Timestamps round trip to the microsecond"), FMath::IsNearlyEqual(FAlakazamFrameHeader::FromTimestampUs(FAlakazamFrameHeader::ToTimestampUs(1234.567891)), 1234.567891, 1e-6));
+	TestTrue(TEXT("Negative times clamp to zero"), FAlakazamFrameHeader::ToTimestampUs(-1.0) == 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamFrameHeaderRejectTest, "Alakazam.FrameHeader.RejectsInvalid",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamFrameHeaderRejectTest::RunTest(const FString& Parameters)
+{
+	TArray64<uint8> Message;
+	MakeTestHeader().Write(Message);
+	FAlakazamFrameHeader Parsed;
+
+	TestEqual(TEXT("Null data"), FAlakazamFrameHeader::Read(nullptr, 100, Parsed), 0ll);
+	for (int64 Size = 0; Size < FAlakazamFrameHeader::EncodedSize; Size++)
+	{
+		if (FAlakazamFrameHeader::Read(Message.GetData(), Size, Parsed) != 0)
+		{
+			AddError(FString::Printf(TEXT("Buffer of %lld bytes was taken for a header"), Size));
+		}
+	}
+
+	// A bare JPEG, as sent before frame headers were negotiated
+	TArray64<uint8> Jpeg;
+	Jpeg.SetNumZeroed(FAlakazamFrameHeader::EncodedSize * 2);
+	Jpeg[0] = 0xFF;
+	Jpeg[1] = 0xD8;
+	TestEqual(TEXT("Bare JPEG"), FAlakazamFrameHeader::Read(Jpeg.GetData(), Jpeg.Num(), Parsed), 0ll);
+
+	TArray64<uint8> BadMagic = Message;
+	BadMagic[3] = 'X';
+	TestEqual(TEXT("Wrong magic"), FAlakazamFrameHeader::Read(BadMagic.GetData(), BadMagic.Num(), Parsed), 0ll);
+
+	TArray64<uint8> VersionZero = Message;
+	VersionZero[4] = 0;
+	TestEqual(TEXT("Version 0"), FAlakazamFrameHeader::Read(VersionZero.GetData(), VersionZero.Num(), Parsed), 0ll);
+
+	TArray64<uint8> TooSmall = Message;
+	WriteU16(TooSmall, 6, FAlakazamFrameHeader::EncodedSize - 4);
+	TestEqual(TEXT("Header size smaller than the known fields"), FAlakazamFrameHeader::Read(TooSmall.GetData(), TooSmall.Num(), Parsed), 0ll);
+
+	TArray64<uint8> PastEnd = Message;
+	WriteU16(PastEnd, 6, FAlakazamFrameHeader::EncodedSize + 8);
+	TestEqual(TEXT("Header size past the end of the message"), FAlakazamFrameHeader::Read(PastEnd.GetData(), PastEnd.Num(), Parsed), 0ll);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamFrameHeaderNewerVersionTest, "Alakazam.FrameHeader.NewerVersion",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamFrameHeaderNewerVersionTest::RunTest(const FString& Parameters)
+{
+	// A later version with 8 more bytes of fields this client does not know
+	const FAlakazamFrameHeader Header = MakeTestHeader();
+	constexpr int32 NewerSize = FAlakazamFrameHeader::EncodedSize + 8;
+	TArray64<uint8> Message;
+	Header.Write(Message);
+	Message[4] = FAlakazamFrameHeader::CurrentVersion + 1;
+	WriteU16(Message, 6, NewerSize);
+	Message.AddZeroed(8);
+	const uint8 Payload[2] = { 0xFF, 0xD8 };
+	Message.Append(Payload, sizeof(Payload));
+
+	FAlakazamFrameHeader Parsed;
+	TestEqual(TEXT("Unknown fields are skipped"), FAlakazamFrameHeader::Read(Message.GetData(), Message.Num(), Parsed), static_cast<int64>(NewerSize));
+	TestEqual(TEXT("Known fields are still read"), static_cast<int64>(Parsed.Sequence), static_cast<int64>(Header.Sequence));
+	TestEqual(TEXT("Known trailing field is still read"), Parsed.InferenceMs, Header.InferenceMs);
+	return true;
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include "AlakazamImageResize.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Random pixels with padding at the end of each row, so the pitch is exercised */
+	FAlakazamPixelView MakeSource(int32 Width, int32 Height, FRandomStream& Random, TArray<uint8>& OutPixels)
+	{
+		const int32 PitchBytes = Width * 4 + 8;
+		OutPixels.SetNumUninitialized(PitchBytes * Height);
+		for (uint8& Byte : OutPixels)
+		{
+			Byte = static_cast<uint8>(Random.RandRange(0, 255));
+		}
+
+		FAlakazamPixelView View;
+		View.Data = OutPixels.GetData();
+		View.Width = Width;
+		View.Height = Height;
+		View.PitchBytes = PitchBytes;
+		View.Format = EAlakazamSourceFormat::BGRA;
+		return View;
+	}
+
+	/** Share of source pixel Index inside the span [Start, End) */
+	double Coverage(int32 Index, double Start, double End)
+	{
+		return FMath::Max(0.0, FMath::Min<double>(Index + 1, End) - FMath::Max<double>(Index, Start));
+	}
+
+	/** Largest difference from a double precision box filter over every covered source pixel */
+	int32 MaxDifferenceFromBoxFilter(const FAlakazamPixelView& Source, int32 DstWidth, int32 DstHeight, const TArray<uint8>& Pixels)
+	{
+		const double ScaleX = static_cast<double>(Source.Width) / DstWidth;
+		const double ScaleY = static_cast<double>(Source.Height) / DstHeight;
+		int32 MaxDiff = 0;
+
+		for (int32 Y = 0; Y < DstHeight; Y++)
+		{
+			const double StartY = Y * ScaleY;
+			const double EndY = (Y + 1) * ScaleY;
+			for (int32 X = 0; X < DstWidth; X++)
+			{
+				const double StartX = X * ScaleX;
+				const double EndX = (X + 1) * ScaleX;
+				double Sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+				for (int32 SourceY = FMath::FloorToInt(StartY); SourceY < FMath::Min(Source.Height, FMath::CeilToInt(EndY)); SourceY++)
+				{
+					const double WeightY = Coverage(SourceY, StartY, EndY);
+					for (int32 SourceX = FMath::FloorToInt(StartX); SourceX < FMath::Min(Source.Width, FMath::CeilToInt(EndX)); SourceX++)
+					{
+						const double Weight = WeightY * Coverage(SourceX, StartX, EndX);
+						const uint8* Pixel = Source.Data + static_cast<int64>(SourceY) * Source.PitchBytes + SourceX * 4;
+						for (int32 Channel = 0; Channel < 4; Channel++)
+						{
+							Sum[Channel] += Weight * Pixel[Channel];
+						}
+					}
+				}
+
+				const uint8* Out = Pixels.GetData() + (Y * DstWidth + X) * 4;
+				for (int32 Channel = 0; Channel < 4; Channel++)
+				{
+					const double Expected = Sum[Channel] / (ScaleX * ScaleY);
+					MaxDiff = FMath::Max(MaxDiff, FMath::RoundToInt(FMath::Abs(Out[Channel] - Expected)));
+				}
+			}
+		}
+		return MaxDiff;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamImageResizeBoxFilterTest, "Alakazam.ImageResize.MatchesBoxFilter",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamImageResizeBoxFilterTest::RunTest(const FString& Parameters)
+{
+	// Whole and fractional ratios, single rows and columns, and one axis left alone
+	const FIntPoint Cases[][2] = {
+		{ FIntPoint(7, 5), FIntPoint(3, 2) },
+		{ FIntPoint(100, 80), FIntPoint(33, 27) },
+		{ FIntPoint(64, 64), FIntPoint(64, 64) },
+		{ FIntPoint(64, 48), FIntPoint(32, 24) },
+		{ FIntPoint(13, 1), FIntPoint(4, 1) },
+		{ FIntPoint(1, 40), FIntPoint(1, 7) },
+		{ FIntPoint(257, 130), FIntPoint(257, 61) },
+		{ FIntPoint(640, 480), FIntPoint(199, 149) },
+	};
+
+	FRandomStream Random(9);
+	TArray<uint8> Pixels;
+	TArray<uint8> Out;
+
+	for (const auto& Case : Cases)
+	{
+		const FAlakazamPixelView Source = MakeSource(Case[0].X, Case[0].Y, Random, Pixels);
+		const FIntPoint Dest = Case[1];
+		if (!AlakazamImageResize::Downscale(Source, Dest.X, Dest.Y, Out))
+		{
+			AddError(FString::Printf(TEXT("%dx%d to %dx%d was refused"), Source.Width, Source.Height, Dest.X, Dest.Y));
+			continue;
+		}
+		if (Out.Num() != Dest.X * Dest.Y * 4)
+		{
+			AddError(FString::Printf(TEXT("%dx%d to %dx%d is not tightly packed"), Source.Width, Source.Height, Dest.X, Dest.Y));
+			continue;
+		}
+
+		const int32 MaxDiff = MaxDifferenceFromBoxFilter(Source, Dest.X, Dest.Y, Out);
+		if (MaxDiff > 1)
+		{
+			AddError(FString::Printf(TEXT("%dx%d to %dx%d is %d off the box filter"), Source.Width, Source.Height, Dest.X, Dest.Y, MaxDiff));
+		}
+	}
+
+	// Same size is a copy, without the row padding
+	const FAlakazamPixelView Source = MakeSource(17, 9, Random, Pixels);
+	AlakazamImageResize::Downscale(Source, Source.Width, Source.Height, Out);
+	bool bCopied = true;
+	for (int32 Y = 0; Y < Source.Height; Y++)
+	{
+		bCopied &= FMemory::Memcmp(Out.GetData() + Y * Source.Width * 4, Source.Data + Y * Source.PitchBytes, Source.Width * 4) == 0;
+	}
+	TestTrue(TEXT("Same size is an exact copy"), bCopied);
+
+	TestFalse(TEXT("Upscaling is refused"), AlakazamImageResize::Downscale(Source, Source.Width + 1, Source.Height, Out));
+	TestFalse(TEXT("Empty destination is refused"), AlakazamImageResize::Downscale(Source, 0, Source.Height, Out));
+	TestFalse(TEXT("Missing source is refused"), AlakazamImageResize::Downscale(FAlakazamPixelView(), 1, 1, Out));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamImageResizeFitWithinTest, "Alakazam.ImageResize.FitWithin",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamImageResizeFitWithinTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Landscape"), AlakazamImageResize::FitWithin(7680, 4320, 1024), FIntPoint(1024, 576));
+	TestEqual(TEXT("Portrait"), AlakazamImageResize::FitWithin(3000, 4000, 1024), FIntPoint(768, 1024));
+	TestEqual(TEXT("Square"), AlakazamImageResize::FitWithin(2048, 2048, 1024), FIntPoint(1024, 1024));
+	TestEqual(TEXT("Already fits"), AlakazamImageResize::FitWithin(500, 300, 1024), FIntPoint(500, 300));
+	TestEqual(TEXT("Exactly fits"), AlakazamImageResize::FitWithin(1024, 300, 1024), FIntPoint(1024, 300));
+	TestEqual(TEXT("No limit"), AlakazamImageResize::FitWithin(7680, 4320, 0), FIntPoint(7680, 4320));
+	TestEqual(TEXT("Thin edge keeps a pixel"), AlakazamImageResize::FitWithin(10000, 2, 100), FIntPoint(100, 1));
+	return true;
+}
+
+#endif
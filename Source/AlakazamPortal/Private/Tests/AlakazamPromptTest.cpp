@@ -0,0 +1,112 @@
+#include "AlakazamPromptDebounce.h"
+#include "AlakazamLatencyTracker.h"
+#include "AlakazamDecodePipeline.h"
+#include "AlakazamTestImages.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamPromptDebounceTest, "Alakazam.Prompt.Debounce",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamPromptDebounceTest::RunTest(const FString& Parameters)
+{
+	constexpr double Window = 0.25;
+	FAlakazamPromptDebounce Debounce;
+
+	TestTrue(TEXT("First change goes out at once"), Debounce.OnChange(10.0, Window));
+	Debounce.OnSent(10.0);
+
+	// A burst inside the window is held back as one change
+	TestFalse(TEXT("Change inside the window is held"), Debounce.OnChange(10.05, Window));
+	TestFalse(TEXT("Later change inside the window is held"), Debounce.OnChange(10.2, Window));
+	TestTrue(TEXT("Held change is pending"), Debounce.IsPending());
+	TestEqual(TEXT("Held change is due one window after the last send"), Debounce.GetFlushTime(Window), 10.25);
+
+	Debounce.OnSent(10.25);
+	TestFalse(TEXT("Sending clears the held change"), Debounce.IsPending());
+
+	TestTrue(TEXT("Change after a quiet spell goes out at once"), Debounce.OnChange(11.0, Window));
+	TestFalse(TEXT("Nothing held for a change sent at once"), Debounce.IsPending());
+	Debounce.OnSent(11.0);
+
+	TestFalse(TEXT("Held again inside the next window"), Debounce.OnChange(11.1, Window));
+	Debounce.Cancel();
+	TestFalse(TEXT("Cancel forgets the held change"), Debounce.IsPending());
+
+	TestTrue(TEXT("A zero window never holds"), Debounce.OnChange(11.1, 0.0));
+
+	Debounce.Reset();
+	TestTrue(TEXT("Reset forgets the last send"), Debounce.OnChange(11.1, Window));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamPromptSwitchLatencyTest, "Alakazam.Prompt.SwitchLatency",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamPromptSwitchLatencyTest::RunTest(const FString& Parameters)
+{
+	FAlakazamLatencyTracker Tracker;
+
+	Tracker.OnPromptChanged(1, 100.0);
+	Tracker.OnPromptShown(0, 100.05);
+	TestFalse(TEXT("A frame of an older prompt is not the switch"), Tracker.HasSamples());
+
+	// Superseded before it was shown: only the latest change is measured, from its own time
+	Tracker.OnPromptChanged(2, 100.1);
+	Tracker.OnPromptShown(1, 100.15);
+	TestFalse(TEXT("A frame of a superseded prompt is not the switch"), Tracker.HasSamples());
+
+	Tracker.OnPromptShown(2, 100.3);
+	TestTrue(TEXT("The first frame of the latest prompt is measured"), Tracker.HasSamples());
+	TestEqual(TEXT("Switch latency runs from the latest change"), Tracker.GetStats().PromptSwitch.P50Ms, 200.0f, 1.0f);
+
+	Tracker.OnPromptShown(2, 100.5);
+	TestEqual(TEXT("Only the first frame after a change is measured"), Tracker.GetStats().PromptSwitch.P50Ms, 200.0f, 1.0f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamPromptStaleRepliesTest, "Alakazam.Prompt.StaleRepliesDropped",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamPromptStaleRepliesTest::RunTest(const FString& Parameters)
+{
+	TArray64<uint8> Jpeg;
+	if (!TestTrue(TEXT("Test image encodes"), AlakazamTestImages::MakeJpeg(64, 48, Jpeg)))
+	{
+		return false;
+	}
+
+	TSharedRef<FAlakazamDecodePipeline, ESPMode::ThreadSafe> Pipeline = MakeShared<FAlakazamDecodePipeline, ESPMode::ThreadSafe>();
+	Pipeline->SetMinPromptEpoch(3);
+
+	FAlakazamReplyInfo Info;
+	Info.bHasHeader = true;
+	Info.Header.Sequence = 1;
+	Info.Header.PromptEpoch = 2;
+	Pipeline->Submit(Jpeg.GetData(), Jpeg.Num(), Info);
+	Pipeline->Flush();
+
+	FAlakazamDecodedFrame Frame;
+	TestFalse(TEXT("Reply captured under an older prompt is not shown"), Pipeline->ConsumeDecoded(Frame));
+	TestEqual(TEXT("Stale reply counts as skipped"), Pipeline->GetFramesSkipped(), 1);
+
+	Info.Header.Sequence = 2;
+	Info.Header.PromptEpoch = 3;
+	Pipeline->Submit(Jpeg.GetData(), Jpeg.Num(), Info);
+	Pipeline->Flush();
+	TestTrue(TEXT("Reply of the current prompt is shown"), Pipeline->ConsumeDecoded(Frame));
+	TestEqual(TEXT("Shown reply is the current one"), static_cast<int32>(Frame.Info.Header.Sequence), 2);
+	TestEqual(TEXT("Decoded width"), Frame.Width, 64);
+	TestEqual(TEXT("Decoded height"), Frame.Height, 48);
+
+	// Replies without a header can't be told apart and are always shown
+	Info.bHasHeader = false;
+	Info.Header = FAlakazamFrameHeader();
+	Pipeline->Submit(Jpeg.GetData(), Jpeg.Num(), Info);
+	Pipeline->Flush();
+	TestTrue(TEXT("Reply without a header is shown"), Pipeline->ConsumeDecoded(Frame));
+	return true;
+}
+
+#endif
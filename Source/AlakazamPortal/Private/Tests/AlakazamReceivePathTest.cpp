@@ -0,0 +1,162 @@
+#include "AlakazamMessageAssembler.h"
+#include "AlakazamDecodePipeline.h"
+#include "AlakazamTestImages.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Feed a message to the assembler in fragments of at most FragmentSize bytes */
+	bool Deliver(FAlakazamMessageAssembler& Assembler, const TArray64<uint8>& Message, int64 FragmentSize, const uint8*& OutData, int64& OutSize)
+	{
+		bool bComplete = false;
+		for (int64 Offset = 0; Offset < Message.Num(); Offset += FragmentSize)
+		{
+			const int64 Size = FMath::Min(FragmentSize, Message.Num() - Offset);
+			bComplete = Assembler.Add(Message.GetData() + Offset, Size, Message.Num() - Offset - Size, OutData, OutSize);
+		}
+		return bComplete;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamReassemblyTest, "Alakazam.ReceivePath.ReassemblyReusesBuffer",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamReassemblyTest::RunTest(const FString& Parameters)
+{
+	FAlakazamMessageAssembler Assembler;
+	Assembler.Reserve(64 * 1024);
+	const uint8* BufferData = Assembler.GetBufferData();
+	const int64 Capacity = Assembler.GetCapacity();
+
+	FRandomStream Random(3);
+	TArray64<uint8> Message;
+	const uint8* Out = nullptr;
+	int64 OutSize = 0;
+
+	for (int32 Index = 0; Index < 50; Index++)
+	{
+		Message.SetNumUninitialized(Random.RandRange(1000, 64 * 1024));
+		for (uint8& Byte : Message)
+		{
+			Byte = static_cast<uint8>(Random.RandRange(0, 255));
+		}
+
+		const int64 FragmentSize = Random.RandRange(100, 16 * 1024);
+		if (!Deliver(Assembler, Message, FragmentSize, Out, OutSize))
+		{
+			AddError(FString::Printf(TEXT("Message %d was not completed"), Index));
+			continue;
+		}
+		if (OutSize != Message.Num() || FMemory::Memcmp(Out, Message.GetData(), OutSize) != 0)
+		{
+			AddError(FString::Printf(TEXT("Message %d was not reassembled intact"), Index));
+		}
+		if (Assembler.GetBufferData() != BufferData || Assembler.GetCapacity() != Capacity)
+		{
+			AddError(FString::Printf(TEXT("Message %d of %lld bytes reallocated the buffer"), Index, Message.Num()));
+		}
+	}
+
+	// Whole messages are not copied at all
+	TestTrue(TEXT("Unfragmented message completes"), Deliver(Assembler, Message, Message.Num(), Out, OutSize));
+	TestTrue(TEXT("Unfragmented message is read from the socket's buffer"), Out == Message.GetData());
+
+	// A message bigger than the reservation grows the buffer once, and then it is kept
+	Message.SetNumZeroed(100 * 1024);
+	TestTrue(TEXT("Oversized message completes"), Deliver(Assembler, Message, 4096, Out, OutSize));
+	BufferData = Assembler.GetBufferData();
+	TestTrue(TEXT("Oversized message fits"), Assembler.GetCapacity() >= Message.Num());
+	Deliver(Assembler, Message, 4096, Out, OutSize);
+	TestTrue(TEXT("Grown buffer is reused"), Assembler.GetBufferData() == BufferData);
+
+	// A message cut off by a disconnect does not prefix the next one
+	Assembler.Add(Message.GetData(), 10, 100, Out, OutSize);
+	TestTrue(TEXT("Partial message is receiving"), Assembler.IsReceiving());
+	Assembler.Reset();
+	TestFalse(TEXT("Reset drops the partial message"), Assembler.IsReceiving());
+	TestTrue(TEXT("Message after the reset completes"), Deliver(Assembler, Message, 4096, Out, OutSize) && OutSize == Message.Num());
+	TestTrue(TEXT("Reset keeps the buffer"), Assembler.GetBufferData() == BufferData);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamReceiveSteadyStateTest, "Alakazam.ReceivePath.SteadyStateReusesBuffers",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamReceiveSteadyStateTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Width = 640;
+	constexpr int32 Height = 360;
+	constexpr int32 WarmUpFrames = 4;
+	constexpr int32 Frames = 40;
+
+	// Striped replies take the parallel decoder, which writes into the pipeline's own buffers
+	TArray<uint8> Pixels;
+	TArray<TArray64<uint8>> Replies;
+	FAlakazamJpegEncoder Encoder;
+	for (uint32 Seed = 1; Seed <= 3; Seed++)
+	{
+		AlakazamTestImages::MakePixels(Width, Height, Pixels, Seed);
+		if (!TestTrue(TEXT("Reply encodes"), Encoder.Encode(AlakazamTestImages::MakeView(Pixels, Width, Height), 80, EAlakazamChromaSubsampling::Yuv420, Replies.AddDefaulted_GetRef(), 4)))
+		{
+			return false;
+		}
+	}
+	if (FAlakazamJpegEncoder::GetAutoStripeCount() < 2)
+	{
+		AddInfo(TEXT("One worker thread: replies take the single-threaded ImageWrapper decode, whose output is not checked here"));
+		return true;
+	}
+
+	FAlakazamMessageAssembler Assembler;
+	Assembler.Reserve(Width * Height);
+	TSharedRef<FAlakazamDecodePipeline, ESPMode::ThreadSafe> Pipeline = MakeShared<FAlakazamDecodePipeline, ESPMode::ThreadSafe>();
+	FAlakazamDecodedFrame Frame;
+	Frame.Pixels.Reserve(Width * Height * 4);
+
+	// Pixel buffers rotate between the worker, the result slot and the displayed frame
+	TSet<const uint8*> PixelBuffers;
+	const uint8* AssemblerData = nullptr;
+	int64 AssemblerCapacity = 0;
+
+	for (int32 Index = 0; Index < WarmUpFrames + Frames; Index++)
+	{
+		const TArray64<uint8>& Reply = Replies[Index % Replies.Num()];
+		const uint8* Message = nullptr;
+		int64 MessageSize = 0;
+		if (!Deliver(Assembler, Reply, 16 * 1024, Message, MessageSize))
+		{
+			AddError(TEXT("Reply was not reassembled"));
+			return false;
+		}
+
+		Pipeline->Submit(Message, MessageSize, FAlakazamReplyInfo());
+		Pipeline->Flush();
+		if (!Pipeline->ConsumeDecoded(Frame) || Frame.Width != Width || Frame.Height != Height)
+		{
+			AddError(FString::Printf(TEXT("Reply %d was not decoded"), Index));
+			return false;
+		}
+
+		if (Index == WarmUpFrames)
+		{
+			AssemblerData = Assembler.GetBufferData();
+			AssemblerCapacity = Assembler.GetCapacity();
+		}
+		if (Index >= WarmUpFrames)
+		{
+			PixelBuffers.Add(Frame.Pixels.GetData());
+			if (Assembler.GetBufferData() != AssemblerData || Assembler.GetCapacity() != AssemblerCapacity)
+			{
+				AddError(FString::Printf(TEXT("Reply %d reallocated the reassembly buffer"), Index));
+			}
+		}
+	}
+
+	TestTrue(TEXT("Pixel buffers are reused rather than reallocated"), PixelBuffers.Num() <= 3);
+	TestEqual(TEXT("No reply was skipped"), Pipeline->GetFramesSkipped(), 0);
+	return true;
+}
+
+#endif
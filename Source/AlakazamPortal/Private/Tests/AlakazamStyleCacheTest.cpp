@@ -0,0 +1,128 @@
+#include "AlakazamStyleCache.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	FString TestKey(uint8 Seed)
+	{
+		const uint8 Bytes[4] = { Seed, 0x4A, 0x50, 0x47 };
+		return FAlakazamStyleCache::MakeKey(Bytes, sizeof(Bytes), false);
+	}
+
+	FString TestPrompt(uint8 Seed)
+	{
+		return FString::Printf(TEXT("watercolour wash, soft edges, style %03d"), Seed);
+	}
+
+	FString TestCachePath()
+	{
+		return FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("AlakazamStyleCacheTest.json"));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamStyleCacheKeyTest, "Alakazam.StyleCache.Key",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamStyleCacheKeyTest::RunTest(const FString& Parameters)
+{
+	const uint8 Bytes[4] = { 1, 2, 3, 4 };
+	const uint8 Other[4] = { 1, 2, 3, 5 };
+	TestEqual(TEXT("Same bytes give the same key"), FAlakazamStyleCache::MakeKey(Bytes, 4, false), FAlakazamStyleCache::MakeKey(Bytes, 4, false));
+	TestNotEqual(TEXT("Different bytes give different keys"), FAlakazamStyleCache::MakeKey(Bytes, 4, false), FAlakazamStyleCache::MakeKey(Other, 4, false));
+	TestNotEqual(TEXT("The enhance flag is part of the key"), FAlakazamStyleCache::MakeKey(Bytes, 4, false), FAlakazamStyleCache::MakeKey(Bytes, 4, true));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamStyleCacheEvictionTest, "Alakazam.StyleCache.EvictsLeastRecentlyUsed",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamStyleCacheEvictionTest::RunTest(const FString& Parameters)
+{
+	FAlakazamStyleCache Cache(TestCachePath());
+	Cache.Clear();
+
+	// Every entry has the same size, so the cap is a whole number of entries
+	Cache.Add(TestKey(1), TestPrompt(1), MAX_int64);
+	const int64 EntrySize = Cache.GetTotalBytes();
+	const int64 MaxBytes = EntrySize * 3;
+	Cache.Add(TestKey(2), TestPrompt(2), MaxBytes);
+	Cache.Add(TestKey(3), TestPrompt(3), MaxBytes);
+	TestEqual(TEXT("Entries up to the cap are kept"), Cache.Num(), 3);
+
+	FString Found;
+	TestTrue(TEXT("Lookup hits"), Cache.Find(TestKey(1), Found));
+	TestEqual(TEXT("Lookup returns the stored prompt"), Found, TestPrompt(1));
+
+	// 1 was just used, so 2 is now the oldest
+	Cache.Add(TestKey(4), TestPrompt(4), MaxBytes);
+	TestEqual(TEXT("Cache stays at the cap"), Cache.Num(), 3);
+	TestTrue(TEXT("Size stays under the cap"), Cache.GetTotalBytes() <= MaxBytes);
+	TestFalse(TEXT("Least recently used entry is evicted"), Cache.Find(TestKey(2), Found));
+	TestTrue(TEXT("Recently used entry survives"), Cache.Find(TestKey(1), Found));
+	TestTrue(TEXT("Newest entry survives"), Cache.Find(TestKey(4), Found));
+
+	// An entry bigger than the whole cap still replaces everything else
+	Cache.Add(TestKey(5), TestPrompt(5), EntrySize / 2);
+	TestEqual(TEXT("Oversized entry is kept alone"), Cache.Num(), 1);
+	TestTrue(TEXT("Oversized entry is found"), Cache.Find(TestKey(5), Found));
+
+	Cache.Clear();
+	TestEqual(TEXT("Clear empties the cache"), Cache.Num(), 0);
+	TestFalse(TEXT("Clear removes the index file"), FPaths::FileExists(TestCachePath()));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlakazamStyleCachePersistenceTest, "Alakazam.StyleCache.Persistence",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FAlakazamStyleCachePersistenceTest::RunTest(const FString& Parameters)
+{
+	const FString Path = TestCachePath();
+	IFileManager::Get().Delete(*Path, false, false, true);
+
+	int64 MaxBytes = 0;
+	{
+		FAlakazamStyleCache Cache(Path);
+		Cache.Add(TestKey(1), TestPrompt(1), MAX_int64);
+		MaxBytes = Cache.GetTotalBytes() * 3;
+		Cache.Add(TestKey(2), TestPrompt(2), MaxBytes);
+		Cache.Add(TestKey(3), TestPrompt(3), MaxBytes);
+	}
+
+	{
+		FAlakazamStyleCache Cache(Path);
+		FString Before;
+		FFileHelper::LoadFileToString(Before, *Path);
+
+		FString Found;
+		TestTrue(TEXT("Entries are read back from disk"), Cache.Find(TestKey(1), Found));
+		TestEqual(TEXT("Prompt is read back from disk"), Found, TestPrompt(1));
+
+		FString After;
+		FFileHelper::LoadFileToString(After, *Path);
+		TestEqual(TEXT("Lookup does not write the index"), After, Before);
+
+		Cache.Flush();
+		FFileHelper::LoadFileToString(After, *Path);
+		TestNotEqual(TEXT("Flush writes the new recency"), After, Before);
+	}
+
+	{
+		// File order carries the recency: 1 was used last, so 2 goes first
+		FAlakazamStyleCache Cache(Path);
+		Cache.Add(TestKey(4), TestPrompt(4), MaxBytes);
+		FString Found;
+		TestFalse(TEXT("Oldest entry after reload is evicted"), Cache.Find(TestKey(2), Found));
+		TestTrue(TEXT("Entry used before the reload survives"), Cache.Find(TestKey(1), Found));
+		TestTrue(TEXT("Other entry survives"), Cache.Find(TestKey(3), Found));
+		Cache.Clear();
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AlakazamColorConvert.h"
+#include "AlakazamJpegEncoder.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Deterministic images shared by the automation tests */
+namespace AlakazamTestImages
+{
+	/** BGRA gradients with some noise, so every channel, row and column differs */
+	inline void MakePixels(int32 Width, int32 Height, TArray<uint8>& OutPixels, uint32 Seed = 1)
+	{
+		OutPixels.SetNumUninitialized(Width * Height * 4);
+		FRandomStream Random(Seed);
+		for (int32 Y = 0; Y < Height; Y++)
+		{
+			for (int32 X = 0; X < Width; X++)
+			{
+				uint8* Pixel = OutPixels.GetData() + (Y * Width + X) * 4;
+				Pixel[0] = static_cast<uint8>((X * 255) / FMath::Max(Width - 1, 1));
+				Pixel[1] = static_cast<uint8>((Y * 255) / FMath::Max(Height - 1, 1));
+				Pixel[2] = static_cast<uint8>(Random.RandRange(0, 255));
+				Pixel[3] = 255;
+			}
+		}
+	}
+
+	inline FAlakazamPixelView MakeView(const TArray<uint8>& Pixels, int32 Width, int32 Height)
+	{
+		FAlakazamPixelView View;
+		View.Data = Pixels.GetData();
+		View.Width = Width;
+		View.Height = Height;
+		View.PitchBytes = Width * 4;
+		View.Format = EAlakazamSourceFormat::BGRA;
+		return View;
+	}
+
+	inline bool MakeJpeg(int32 Width, int32 Height, TArray64<uint8>& OutJpeg, uint32 Seed = 1)
+	{
+		TArray<uint8> Pixels;
+		MakePixels(Width, Height, Pixels, Seed);
+		FAlakazamJpegEncoder Encoder;
+		return Encoder.Encode(MakeView(Pixels, Width, Height), 90, EAlakazamChromaSubsampling::Yuv444, OutJpeg);
+	}
+}
+
+#endif
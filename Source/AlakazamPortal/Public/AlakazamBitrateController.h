@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Adaptive bitrate
+ *
+ * Watches the round trip of streamed frames (sent to stylized reply) and backs off when
+ * latency builds up: first JPEG quality comes down, then the capture resolution steps down
+ * a small ladder. After a stretch without congestion it climbs back the same way.
+ *
+ * Congestion is a smoothed round trip well above the best one seen recently or still rising,
+ * the oldest unanswered frame waiting too long, or a delivered bitrate (bytes of answered
+ * frames per second) falling well short of the bitrate being sent: the link or the server
+ * is not keeping up even if the queue has not shown in the round trip yet.
+ *
+ * Replies are matched to sent frames by the sequence number echoed in their frame header, or
+ * in order when they have none. Game thread only.
+ */
+class ALAKAZAMPORTAL_API FAlakazamBitrateController
+{
+public:
+	/** Capture size scale of each rung, from full resolution down */
+	static constexpr float LadderScales[] = { 1.0f, 0.75f, 0.5f };
+	static constexpr int32 NumRungs = UE_ARRAY_COUNT(LadderScales);
+
+	/** Quality stays within these limits; the current quality is clamped to them */
+	void SetQualityRange(int32 InMaxQuality, int32 InMinQuality);
+
+	/** Start over at full resolution and the maximum quality */
+	void Reset();
+
+	void OnFrameSent(double SendTime, int64 Bytes, uint32 Sequence);
+
+	/** A reply without a frame header answers the oldest unanswered frame */
+	void OnFrameAnswered(double Now);
+
+	/** A reply echoing Sequence answers that frame; older unanswered ones will not be answered */
+	void OnFrameAnswered(double Now, uint32 Sequence);
+
+	/** The server dropped frames without answering them */
+	void OnFramesWrittenOff();
+
+	/** Re-evaluate quality and rung. Returns true if either changed. */
+	bool Update(double Now);
+
+	int32 GetQuality() const { return Quality; }
+	int32 GetRung() const { return Rung; }
+	float GetRoundTripMs() const { return static_cast<float>(SmoothedRtt * 1000.0); }
+	float GetDeliveredKbps() const { return DeliveredKbps; }
+
+	/** Capture size of a rung for a full-resolution size, kept a multiple of 8 */
+	static FIntPoint GetRungSize(int32 Rung, int32 FullWidth, int32 FullHeight);
+
+private:
+	bool IsCongested(double Now) const;
+	void AnswerPendingFrame(int32 Index, double Now);
+
+	struct FPendingFrame
+	{
+		double SendTime = 0.0;
+		int64 Bytes = 0;
+		uint32 Sequence = 0;
+	};
+
+	TArray<FPendingFrame> Pending;
+
+	int32 MaxQuality = 85;
+	int32 MinQuality = 40;
+	int32 Quality = 85;
+	int32 Rung = 0;
+
+	double SmoothedRtt = 0.0;
+	double MinRtt = 0.0;
+	double MinRttTime = 0.0;
+	double LastEvaluation = 0.0;
+	double LastEvaluationRtt = 0.0;
+	double LastChange = 0.0;
+	double LastCongestion = 0.0;
+	bool bWrittenOff = false;
+
+	int64 DeliveredBytes = 0;
+	float DeliveredKbps = 0.0f;
+	int64 SentBytes = 0;
+	float SentKbps = 0.0f;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Channel order of 8-bit, 4-channel source pixels */
+enum class EAlakazamSourceFormat : uint8
+{
+	BGRA,	// Capture render targets (PF_B8G8R8A8)
+	RGBA
+};
+
+/** Layouts the colour conversion kernels can produce */
+enum class EAlakazamPixelLayout : uint8
+{
+	Luma,	// Single Y plane
+	RGB24,	// Packed 3 bytes per pixel
+	YUV444,	// Planar Y, Cb, Cr at full resolution
+	YUV422,	// Planar, chroma halved horizontally
+	YUV420,	// Planar, chroma halved in both directions
+	NV12	// Y plane plus interleaved CbCr plane at quarter resolution
+};
+
+/** Instruction sets the conversion kernels can be written in, in order of width per CPU family */
+enum class EAlakazamKernelSet : uint8
+{
+	Scalar,
+	SSE2,
+	SSSE3,
+	AVX2,
+	NEON
+};
+
+/** Borrowed view of 4-channel pixels with an arbitrary row pitch */
+struct FAlakazamPixelView
+{
+	const uint8* Data = nullptr;
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 PitchBytes = 0;
+	EAlakazamSourceFormat Format = EAlakazamSourceFormat::BGRA;
+};
+
+/**
+ * Converted image. Planes are tightly packed and keep their allocation between frames,
+ * so a long-lived instance converts without allocating.
+ * Colour space is full-range BT.601 (JFIF), matching what JPEG expects.
+ */
+struct ALAKAZAMPORTAL_API FAlakazamPlanarImage
+{
+	EAlakazamPixelLayout Layout = EAlakazamPixelLayout::YUV420;
+	int32 Width = 0;
+	int32 Height = 0;
+
+	TArray64<uint8> Planes[3];
+	int32 PlaneWidth[3] = { 0, 0, 0 };	// Bytes per row
+	int32 PlaneHeight[3] = { 0, 0, 0 };
+	int32 NumPlanes = 0;
+
+	/** Size the planes for a layout, reusing existing memory */
+	void Allocate(EAlakazamPixelLayout InLayout, int32 InWidth, int32 InHeight);
+
+	uint8* GetRow(int32 Plane, int32 Row) { return Planes[Plane].GetData() + static_cast<int64>(Row) * PlaneWidth[Plane]; }
+	const uint8* GetRow(int32 Plane, int32 Row) const { return Planes[Plane].GetData() + static_cast<int64>(Row) * PlaneWidth[Plane]; }
+};
+
+/**
+ * One-pass colour conversion kernels for the capture path.
+ * Each source/destination pair is a separate template instantiation; inside it the widest
+ * instruction set enabled at compile time is used (AVX2, SSE2/SSSE3 or NEON) with a scalar
+ * fallback for row tails and other platforms. All paths produce identical output.
+ */
+namespace AlakazamColorConvert
+{
+	/**
+	 * Convert a band of rows. Dst must already be allocated for the full image.
+	 * For YUV420 and NV12, FirstRow must be even. Bands may be converted concurrently.
+	 */
+	template<EAlakazamSourceFormat SourceFormat, EAlakazamPixelLayout Layout>
+	void ConvertRows(const FAlakazamPixelView& Source, FAlakazamPlanarImage& Dest, int32 FirstRow, int32 NumRows);
+
+	/**
+	 * Allocate Dest and convert the whole image, dispatching to the matching instantiation.
+	 * With NumBands > 1 the image is split into horizontal bands converted in parallel.
+	 */
+	ALAKAZAMPORTAL_API void Convert(const FAlakazamPixelView& Source, EAlakazamPixelLayout Layout, FAlakazamPlanarImage& Dest, int32 NumBands = 1);
+
+	/** Convert a band of rows of an already allocated Dest, dispatching to the matching instantiation */
+	ALAKAZAMPORTAL_API void ConvertRows(const FAlakazamPixelView& Source, FAlakazamPlanarImage& Dest, int32 FirstRow, int32 NumRows);
+
+	/** Instruction set the kernels were compiled for, for logs and stats */
+	ALAKAZAMPORTAL_API const TCHAR* GetKernelName();
+
+	ALAKAZAMPORTAL_API const TCHAR* GetKernelSetName(EAlakazamKernelSet KernelSet);
+
+	/** Instruction sets compiled into this build, Scalar first */
+	ALAKAZAMPORTAL_API TArray<EAlakazamKernelSet> GetAvailableKernelSets();
+
+	/**
+	 * Use no kernels wider than KernelSet, so tests and benchmarks can compare each one with
+	 * the scalar reference. Global; only change it while no conversion is running.
+	 */
+	ALAKAZAMPORTAL_API void SetMaxKernelSet(EAlakazamKernelSet KernelSet);
+}
@@ -5,6 +5,16 @@
 #include "Engine/TextureRenderTarget2D.h"
 #include "IWebSocket.h"
 #include "RHIGPUReadback.h"
+#include "AlakazamEncodePipeline.h"
+#include "AlakazamJpegEncoder.h"
+#include "AlakazamDecodePipeline.h"
+#include "AlakazamBitrateController.h"
+#include "AlakazamFrameHeader.h"
+#include "AlakazamLatencyTracker.h"
+#include "AlakazamFrameMailbox.h"
+#include "AlakazamMessageAssembler.h"
+#include "AlakazamPromptDebounce.h"
+#include "Containers/Ticker.h"
 #include "AlakazamController.generated.h"
 
 UENUM(BlueprintType)
@@ -22,6 +32,12 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAlakazamFrameReceived, UTexture2D
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAlakazamError, const FString&, ErrorMessage);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAlakazamStyleExtracted, const FString&, ExtractedPrompt);
 
+/** C++ counterpart of FOnAlakazamFrameReceived, with the echoed frame header of the reply */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnAlakazamFrameReceivedNative, UTexture2D* /*StylizedFrame*/, const FAlakazamReplyInfo& /*Info*/);
+
+/** Runs on the render thread once a reply has been written into the output texture's RHI resource */
+using FAlakazamFrameUploadedCallback = TFunction<void(FRHICommandListImmediate& RHICmdList, FRHITexture* StylizedFrame, const FAlakazamReplyInfo& Info)>;
+
 /**
  * Alakazam Portal Controller
  *
@@ -47,6 +63,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Style")
 	bool bEnhancePrompt = true;
 
+	/** SetPrompt sends at most one prompt per this many seconds; calls in between only keep the latest, sent when the window ends. 0 sends every call. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Style", meta = (ClampMin = "0", ClampMax = "5"))
+	float PromptDebounceSeconds = 0.25f;
+
+	/** Reference images are downscaled to this longer edge before upload. 0 sends them at full size. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Style", meta = (ClampMin = "0", ClampMax = "8192"))
+	int32 ReferenceImageMaxEdge = 1024;
+
+	/** Size cap (KB) of the on-disk cache of prompts extracted from reference images, shared by all controllers. A cached image skips the server entirely. 0 disables the cache. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Style", meta = (ClampMin = "0"))
+	int32 StyleCacheMaxKB = 1024;
+
+	/** Preset styles registered with the server on connect, so SwitchStyle changes style with a single small message */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Style")
+	class UAlakazamStyleBank* StyleBank = nullptr;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
 	int32 CaptureWidth = 1280;
 
@@ -56,9 +88,69 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
 	int32 JpegQuality = 85;
 
+	/** Chroma subsampling of streamed frames. 4:2:0 is smallest and fastest; 4:4:4 keeps fine colour detail. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
+	EAlakazamChromaSubsampling ChromaSubsampling = EAlakazamChromaSubsampling::Yuv420;
+
+	/** Horizontal stripes each frame is split into for parallel JPEG encoding. 0 uses one per worker thread, 1 encodes on a single thread. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0", ClampMax = "64"))
+	int32 EncodeStripes = 0;
+
+	/** Send only the 64x64 tiles that changed since the previous frame, with periodic full keyframes. Used only if the server accepts delta frames on connect. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
+	bool bDeltaFrames = false;
+
+	/** Frames between full keyframes when sending delta frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "1", EditCondition = "bDeltaFrames"))
+	int32 DeltaKeyframeInterval = 60;
+
+	/** Share of changed tiles above which a full keyframe is sent instead of a delta */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bDeltaFrames"))
+	float DeltaMaxDirtyFraction = 0.5f;
+
+	/** Camera movement between two frames (cm) treated as a cut, which forces a keyframe */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0", EditCondition = "bDeltaFrames"))
+	float DeltaCameraCutDistance = 100.0f;
+
+	/** Camera rotation between two frames (degrees) treated as a cut, which forces a keyframe */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0", EditCondition = "bDeltaFrames"))
+	float DeltaCameraCutAngle = 15.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
 	float TargetFPS = 30.0f;
 
+	/** Flow control window: most frames captured but not yet answered by the server. Each stylized frame received returns a credit. 0 paces by TargetFPS alone. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0", ClampMax = "16"))
+	int32 MaxFramesInFlight = 0;
+
+	/** Seconds without any reply before unanswered frames are written off and their credits returned */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0.1", EditCondition = "MaxFramesInFlight > 0"))
+	float FrameCreditTimeoutSeconds = 2.0f;
+
+	/** Adapt JPEG quality and capture resolution to the measured round trip, backing off when latency builds up. JpegQuality and CaptureWidth/Height are the upper limits. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
+	bool bAdaptiveBitrate = false;
+
+	/** Lowest JPEG quality adaptive bitrate uses before stepping the capture resolution down */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "1", ClampMax = "100", EditCondition = "bAdaptiveBitrate"))
+	int32 MinJpegQuality = 40;
+
+	/** Number of GPU readbacks (and capture targets) kept in flight, so captures overlap readback latency. Applied when capture is set up. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 ReadbackRingSize = 3;
+
+	/** Seconds a readback may stay pending before its slot is recycled instead of stalling the stream */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "0.1"))
+	float ReadbackTimeoutSeconds = 1.0f;
+
+	/** If true, only the newest readback is encoded when the game thread falls behind; older ones are released unsent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
+	bool bLatestFrameWins = true;
+
+	/** Maximum frames queued for encoding on worker threads. Further frames are dropped until the encoder catches up. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 MaxEncodeQueueDepth = 2;
+
 	/** If true, automatically capture from the player's camera view (like Unity). If false, use manually assigned SceneCaptureComponent. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Alakazam|Capture")
 	bool bCaptureFromPlayerCamera = true;
@@ -72,6 +164,7 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Output")
 	UTexture2D* OutputTexture;
 
+	/** Most recently captured render target */
 	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Output")
 	UTextureRenderTarget2D* CaptureRenderTarget;
 
@@ -91,6 +184,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
 	bool bIsUsingImageStyle = false;
 
+	/** Style bank entry last selected with SwitchStyle; None once the prompt is set any other way */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
+	FName ActiveStyleId;
+
 	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
 	int32 FramesSent = 0;
 
@@ -100,6 +197,66 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
 	float CurrentFPS = 0.0f;
 
+	/** JPEG quality streamed frames are encoded at */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	int32 ActiveJpegQuality = 0;
+
+	/** Resolution frames are captured at. Below CaptureWidth/Height while adaptive bitrate has stepped down. */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	FIntPoint ActiveCaptureSize = FIntPoint::ZeroValue;
+
+	/** Smoothed time from sending a frame to receiving its stylized reply */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	float RoundTripMs = 0.0f;
+
+	/** Uplink bitrate of the frames the server answered */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	float EstimatedUplinkKbps = 0.0f;
+
+	/** Time from capturing the last displayed frame to showing its stylized version. Needs frame headers. */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	float FrameLatencyMs = 0.0f;
+
+	/** Inference time the server reported for the last displayed frame. Needs frame headers. */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	float ServerInferenceMs = 0.0f;
+
+	/** True when the server agreed to binary frame headers during the handshake */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
+	bool bFrameHeadersEnabled = false;
+
+	/** True when the server agreed to delta frames during the handshake; otherwise every frame is a keyframe */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
+	bool bDeltaFramesEnabled = false;
+
+	/** True when the server accepts reference images as binary image_prompt messages instead of base64 JSON */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
+	bool bBinaryImagePromptsEnabled = false;
+
+	/** True when the server accepted the style bank registration, so SwitchStyle sends IDs */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|State")
+	bool bStyleBankEnabled = false;
+
+	/** Frames captured but not yet answered: in readback, being encoded or awaiting the server's reply */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	int32 FramesInFlight = 0;
+
+	/** Readback slots recycled by the watchdog because the GPU never reported them ready */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	int32 ReadbacksTimedOut = 0;
+
+	/** Replies dropped without being shown: out of order, answering an old prompt, or overtaken by a newer one before display */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	int32 RepliesSkipped = 0;
+
+	/** Timing of the worker-thread encode stage */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	FAlakazamEncodeStats EncodeStats;
+
+	/** Per-stage latency percentiles over recent frames, refreshed every second. A session summary goes to Saved/Profiling/Alakazam on disconnect. */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam|Stats")
+	FAlakazamLatencyStats LatencyStats;
+
 	// === Events ===
 
 	UPROPERTY(BlueprintAssignable, Category = "Alakazam|Events")
@@ -108,6 +265,9 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Alakazam|Events")
 	FOnAlakazamFrameReceived OnFrameReceived;
 
+	/** Broadcast on the game thread right after OnFrameReceived, without Blueprint dispatch */
+	FOnAlakazamFrameReceivedNative OnFrameReceivedNative;
+
 	UPROPERTY(BlueprintAssignable, Category = "Alakazam|Events")
 	FOnAlakazamError OnError;
 
@@ -122,8 +282,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Alakazam")
 	void Disconnect();
 
+	/** Change the prompt. Rapid changes are coalesced (see PromptDebounceSeconds) unless bImmediate is set. */
+	UFUNCTION(BlueprintCallable, Category = "Alakazam")
+	void SetPrompt(const FString& NewPrompt, bool bImmediate = false);
+
+	/** Send a prompt SetPrompt is still holding back, without waiting for the debounce window */
 	UFUNCTION(BlueprintCallable, Category = "Alakazam")
-	void SetPrompt(const FString& NewPrompt);
+	void FlushPendingPrompt();
+
+	/**
+	 * Switch to a style of the StyleBank. Sends only the ID when the style was registered on
+	 * connect, otherwise the style's prompt. Returns false if the style is unknown or unresolved.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Alakazam")
+	bool SwitchStyle(FName StyleId);
 
 	/** Set style from a reference image texture. Server will analyze and extract style. Requires being connected first. */
 	UFUNCTION(BlueprintCallable, Category = "Alakazam")
@@ -157,6 +329,13 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Alakazam")
 	bool IsReady() const;
 
+	/**
+	 * Set (or clear, with an empty function) the render thread frame callback. Uploads already
+	 * queued keep the callback they were queued with, so FlushRenderingCommands() before
+	 * destroying anything a replaced callback captured.
+	 */
+	void SetFrameUploadedCallback(FAlakazamFrameUploadedCallback Callback);
+
 protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -167,34 +346,172 @@ private:
 	FString SessionId;
 
 	float FrameTimer = 0.0f;
+
+	// Flow control: frames sent to the server that have not been answered yet
+	int32 FramesAwaitingReply = 0;
+	double LastReplyTime = 0.0;
+
+	// Adaptive bitrate: round trip tracking and the quality/resolution it picks
+	FAlakazamBitrateController Bitrate;
+	TArray<FAlakazamSentFrame> SentFrames;
+	bool bAdaptiveBitrateActive = false;
 	float FPSTimer = 0.0f;
 	int32 FPSFrameCount = 0;
 
-	TArray<uint8> ReceiveBuffer;
+	// Reassembles fragmented binary messages
+	FAlakazamMessageAssembler ReceiveAssembler;
+	double ReceiveStartTime = 0.0;	// First fragment of the message being received
+
+	// Last reply handed over by the decode pipeline; its pixel buffer is reused for the next one
+	FAlakazamDecodedFrame DisplayedFrame;
+	int32 RepliesDropped = 0;
+
+	FAlakazamLatencyTracker Latency;
+
+	// Decodes replies on a worker thread, keeping only the newest
+	TSharedPtr<FAlakazamDecodePipeline, ESPMode::ThreadSafe> DecodePipeline;
 
 	// Extraction-only mode state
 	bool bExtractionOnlyMode = false;
 	bool bCaptureSetupDone = false;
 
+	// Prepared reference image waiting for the connection to become ready
+	TArray64<uint8> PendingStyleImage;
+
+	// Reference image being downscaled and encoded off the game thread. Its mip stays locked
+	// until the task is done, and the property keeps it alive meanwhile.
 	UPROPERTY()
-	UTexture2D* PendingStyleImage = nullptr;
+	UTexture2D* PreparingImage = nullptr;
+	bool bPreparingMipLocked = false;
+	bool bPreparingSourceLocked = false;
+
+	// Reference image whose extracted prompt is awaited, so the editor can store it in the style bank
+	TWeakObjectPtr<UTexture2D> ExtractingImage;
+	UE::Tasks::FTask ReferencePrepTask;
+	uint32 ReferencePrepId = 0;
+
+	// Style cache key of the reference image awaiting its extracted prompt
+	FString PendingStyleCacheKey;
+
+	// Style bank entries the server was given on connect
+	TSet<FName> RegisteredStyles;
+
+	// Prompt coalescing: Prompt holds a change not sent yet while one is pending. The core
+	// ticker sends it, since components don't tick in the editor.
+	FAlakazamPromptDebounce PromptDebounce;
+	FTSTicker::FDelegateHandle PromptFlushTicker;
 
 	// Auto-created scene capture for player camera mode
 	UPROPERTY()
 	class USceneCaptureComponent2D* AutoSceneCapture;
 
-	// Async GPU readback to avoid blocking game thread
-	FRHIGPUTextureReadback* GPUReadback = nullptr;
-	bool bReadbackPending = false;
-	bool bReadbackDataReady = false;
-	TArray<FColor> ReadbackPixels;
-	FCriticalSection ReadbackLock;
+	// Async GPU readback ring to avoid blocking game thread
+	enum class EReadbackSlotState : uint8
+	{
+		Free,
+		Pending,	// Copy enqueued, waiting for the GPU
+		Mapping,	// Render thread is locking the staging memory
+		Mapped,		// Staging memory locked and published as an FMappedFrame
+		Encoding,	// Encoder is reading straight from the locked memory
+		Encoded		// Encoder is done, staging memory can be unlocked
+	};
+
+	// Slot state is handed between game, render and encoder threads, so it is atomic
+	struct FReadbackSlot
+	{
+		FRHIGPUTextureReadback* Readback = nullptr;
+		UTextureRenderTarget2D* RenderTarget = nullptr; // Owned by CaptureTargets
+		std::atomic<EReadbackSlotState> State{EReadbackSlotState::Free};
+		uint32 Sequence = 0;
+		double IssueTime = 0.0;
+		FVector CameraLocation = FVector::ZeroVector;	// Capture camera pose when the frame was taken
+		FRotator CameraRotation = FRotator::ZeroRotator;
+		float CameraFOV = 0.0f;
+		uint32 PromptEpoch = 0;
+	};
+
+	// A mapped readback handed from the render thread to the game thread.
+	// Whoever holds it owns the slot until it is unlocked or given to the encoder.
+	struct FMappedFrame
+	{
+		int32 SlotIndex = INDEX_NONE;
+		uint32 Sequence = 0;
+		const uint8* Data = nullptr;
+		int32 PitchBytes = 0;
+		double MappedTime = 0.0;
+	};
+
+	TArray<FReadbackSlot> ReadbackSlots;
+	TAlakazamSpscQueue<FMappedFrame, 8> MappedFrameQueue; // Capacity covers the largest ring
+	TAlakazamLatestMailbox<FMappedFrame> LatestMappedFrame;
+	TSharedPtr<FAlakazamEncodePipeline, ESPMode::ThreadSafe> EncodePipeline;
+	uint32 NextCaptureSequence = 0;
+	uint32 LastSentSequence = 0;
+	uint32 LastReceivedSequence = 0;
+
+	// Bumped on every prompt or style change and stamped on frame headers
+	uint32 PromptEpoch = 0;
+	FVector LastSentCameraLocation = FVector::ZeroVector;
+	FRotator LastSentCameraRotation = FRotator::ZeroRotator;
+
+	// Keeps the per-slot capture targets alive
+	UPROPERTY()
+	TArray<UTextureRenderTarget2D*> CaptureTargets;
+
+	// Output textures by size, most recently used last, so switching between capture
+	// resolutions reuses them instead of creating a texture each time
+	UPROPERTY()
+	TArray<UTexture2D*> OutputTexturePool;
+
+	// Pixels handed to the render thread for uploading into OutputTexture
+	struct FUploadBuffer
+	{
+		TArray<uint8> Pixels;
+		std::atomic<bool> bInUse{false};
+	};
+	TArray<TSharedRef<FUploadBuffer, ESPMode::ThreadSafe>> UploadBuffers;
+
+	// Shared with queued uploads, so replacing it never races the render thread
+	TSharedPtr<FAlakazamFrameUploadedCallback, ESPMode::ThreadSafe> FrameUploadedCallback;
 
 	void SetupCapture();
 	void CaptureAndSendFrame();
 	void ProcessAsyncReadback();
+	void UpdateFramesInFlight(int32 NewlySent);
+	void UpdateCaptureSettings();
+	void ReallocateCapture(int32 Width, int32 Height);
+	void ReserveReceiveBuffers(int32 Width, int32 Height);
+	bool SubmitMappedFrame(const FMappedFrame& Frame);
+	void RecycleReadbackSlot(FReadbackSlot& Slot);
+	void UnlockReadbackSlot(FReadbackSlot& Slot);
+	void ReleaseReadbackSlots();
+	void ReleasePipelines();
+	FReadbackSlot* FindFreeReadbackSlot();
 	void ProcessReceivedFrame(const void* Data, SIZE_T Size);
+	void PresentDecodedFrame();
+	UTexture2D* AcquireOutputTexture(int32 Width, int32 Height);
+	bool UploadOutputTexture(TArray<uint8>& Pixels, int32 Width, int32 Height, const FAlakazamReplyInfo& Info);
 	void SyncCaptureWithPlayerCamera();
 	void ConnectForExtractionOnly();
 	void SendPendingImageForExtraction();
+	void BumpPromptEpoch();
+	void SendPrompt(bool bEnhance);
+	bool HandlePromptFlushTick(float DeltaTime);
+	void CancelPromptFlush();
+
+	/** Get the bytes to upload for Image and their style cache key off the game thread; empty bytes on failure */
+	void PrepareReferenceImage(UTexture2D* Image, TFunction<void(TArray64<uint8>& ImageData, const FString& CacheKey)> OnPrepared);
+	void FinishReferenceImagePrep();
+
+	/** Apply the prompt cached for Key on a hit. On a miss, remembers the key for the reply. */
+	bool ApplyCachedStyle(const FString& CacheKey);
+
+	/** In the editor, fill in ExtractedPrompt of style bank entries using the image just extracted */
+	void StoreExtractedStylePrompt(const FString& ExtractedPrompt);
+
+	/** Prompt a style bank entry stands for */
+	bool ResolveStyle(const struct FAlakazamStyleBankEntry& Entry, FString& OutPrompt, bool& bOutEnhance) const;
+	void RegisterStyleBank(class FJsonObject& AuthMsg);
+	bool SendImagePrompt(const uint8* ImageData, int64 ImageSize);
+	void SendImagePromptJson(const FString& Base64ImageData);
 };
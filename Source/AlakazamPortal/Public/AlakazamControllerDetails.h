@@ -8,6 +8,7 @@
 #include "Input/Reply.h"
 
 class UAlakazamController;
+class UAlakazamLoadImageAsync;
 
 /**
  * Custom Details panel for AlakazamController.
@@ -18,6 +19,8 @@ class FAlakazamControllerDetails : public IDetailCustomization
 public:
 	static TSharedRef<IDetailCustomization> MakeInstance();
 
+	virtual ~FAlakazamControllerDetails();
+
 	virtual void CustomizeDetails(IDetailLayoutBuilder& DetailBuilder) override;
 
 private:
@@ -35,6 +38,10 @@ private:
 
 	// Helper to load image from file
 	void LoadImageFromPath(const FString& FilePath);
+	void HandleImageLoaded(UTexture2D* Texture, FString FilePath);
+
+	// Image still loading in the background; cancelled when the panel goes away
+	TWeakObjectPtr<UAlakazamLoadImageAsync> PendingLoad;
 
 	// Get status text for display
 	FText GetStatusText() const;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "AlakazamJpegDecoder.h"
+#include "AlakazamFrameHeader.h"
+#include <atomic>
+
+class IImageWrapper;
+
+/** What is known about a reply before it is decoded */
+struct FAlakazamReplyInfo
+{
+	FAlakazamFrameHeader Header;
+	bool bHasHeader = false;
+	bool bPng = false;
+	double FirstByteTime = 0.0;	// First fragment of the message arrived
+};
+
+/** A decoded reply, ready to be shown */
+struct FAlakazamDecodedFrame
+{
+	FAlakazamReplyInfo Info;
+	TArray<uint8> Pixels;	// BGRA8
+	int32 Width = 0;
+	int32 Height = 0;
+	int64 CompressedSize = 0;
+	double DecodedTime = 0.0;
+};
+
+/**
+ * Reply decode pipeline
+ *
+ * Decodes received JPEG/PNG replies on a worker thread. Only the newest payload is kept:
+ * one submitted while another is still waiting replaces it, and a decoded frame the game
+ * thread has not picked up yet is overwritten by the next one. Pixel buffers rotate between
+ * the worker and the consumer, so steady-state streaming allocates nothing here.
+ * Construct, Submit(), ConsumeDecoded() and Flush() on the game thread; the owner must
+ * Flush() before releasing its reference (a running decode keeps the pipeline alive).
+ */
+class ALAKAZAMPORTAL_API FAlakazamDecodePipeline : public TSharedFromThis<FAlakazamDecodePipeline, ESPMode::ThreadSafe>
+{
+public:
+	FAlakazamDecodePipeline();
+
+	/** Copy a compressed reply in for decoding. Returns false if it replaced one that was never decoded. */
+	bool Submit(const uint8* Data, int64 Size, const FAlakazamReplyInfo& Info);
+
+	/**
+	 * Take the newest decoded frame, if one finished since the last call. Pixel buffers are
+	 * swapped with OutFrame's, so keep passing the same frame to reuse its allocation.
+	 */
+	bool ConsumeDecoded(FAlakazamDecodedFrame& OutFrame);
+
+	/** Replies to frames captured before this prompt epoch are dropped instead of decoded */
+	void SetMinPromptEpoch(uint32 Epoch) { MinPromptEpoch.store(Epoch); }
+
+	/** Block until the worker is idle */
+	void Flush();
+
+	/** Replies dropped without being shown: replaced while waiting, stale epoch, or never picked up */
+	int32 GetFramesSkipped() const { return FramesSkipped.load(); }
+
+private:
+	struct FPayload
+	{
+		FAlakazamReplyInfo Info;
+		TArray<uint8> Data;
+	};
+
+	void RunWorker();
+	bool Decode(const FPayload& Payload, FAlakazamDecodedFrame& OutFrame);
+
+	// Latest payload waiting for the worker, and whether the worker is running
+	FCriticalSection PendingLock;
+	FPayload Pending;
+	bool bHasPending = false;
+	bool bWorkerRunning = false;
+	UE::Tasks::FTask WorkerTask;
+
+	// Worker-owned
+	FPayload Working;
+	FAlakazamDecodedFrame DecodeTarget;
+	FAlakazamJpegDecoder JpegDecoder;
+	TSharedPtr<IImageWrapper> JpegWrapper;
+	TSharedPtr<IImageWrapper> PngWrapper;
+
+	// Newest decoded frame, until the game thread takes it
+	FCriticalSection ResultLock;
+	FAlakazamDecodedFrame Result;
+	bool bHasResult = false;
+
+	std::atomic<uint32> MinPromptEpoch{0};
+	std::atomic<int32> FramesSkipped{0};
+};
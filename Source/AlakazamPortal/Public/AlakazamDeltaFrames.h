@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AlakazamJpegEncoder.h"
+
+class IImageWrapper;
+class IImageWrapperModule;
+
+/**
+ * Delta frames
+ *
+ * Between keyframes only the regions of the capture that changed are sent. Keyframes are
+ * plain JPEGs; delta frames are a small binary envelope of JPEG-coded rectangles
+ * (all fields little endian):
+ *
+ *   Header:  uint8[4] Magic "AKDT", uint8 Version, uint8 Reserved, uint16 NumRects,
+ *            uint16 FrameWidth, uint16 FrameHeight
+ *   Rect:    uint16 X, uint16 Y, uint16 Width, uint16 Height, uint32 JpegSize,
+ *            JpegSize bytes of baseline JPEG
+ *
+ * A delta applies on top of the last keyframe and every delta after it, so a receiver that
+ * missed a message should wait for the next keyframe. Delta frames are only sent when the
+ * server echoes the delta_frames version offered in the auth message.
+ */
+namespace AlakazamDelta
+{
+	constexpr uint8 Version = 1;
+	constexpr int32 HeaderSize = 12;
+	constexpr int32 RectHeaderSize = 12;
+
+	/** Tile edge in pixels. A multiple of 16, so rectangles stay aligned to 4:2:0 MCUs. */
+	constexpr int32 TileSize = 64;
+
+	ALAKAZAMPORTAL_API bool IsDeltaEnvelope(const uint8* Data, int64 Size);
+}
+
+/**
+ * Send side: compares fixed-size tiles of each frame with a copy of the previous frame and
+ * encodes the ones that changed. Runs on the encode worker; one call at a time.
+ */
+class ALAKAZAMPORTAL_API FAlakazamDeltaEncoder
+{
+public:
+	/** Frames between keyframes */
+	int32 KeyframeInterval = 60;
+
+	/** A keyframe is cheaper than a delta once this share of tiles changed */
+	float MaxDirtyFraction = 0.5f;
+
+	/**
+	 * Compare the frame's tiles with the previous frame and write a delta envelope of the
+	 * changed ones. Returns false when a keyframe should be sent instead: the first frame,
+	 * a size change, a forced keyframe, the interval running out or too many changed tiles.
+	 * The previous frame is updated either way, so the caller must send whatever this frame becomes.
+	 */
+	bool EncodeDelta(const FAlakazamPixelView& Pixels, int32 Quality, EAlakazamChromaSubsampling Subsampling, bool bForceKeyframe, TArray64<uint8>& OutEnvelope);
+
+	/** Forget the previous frame, so the next one is a keyframe */
+	void Reset();
+
+	/** Share of tiles that changed in the last frame (0-1) */
+	float GetLastDirtyFraction() const { return LastDirtyFraction; }
+
+private:
+	FAlakazamJpegEncoder Encoder;
+	TArray64<uint8> RectJpeg;
+	TArray64<uint8> PreviousFrame;	// Tightly packed BGRA
+	TArray<bool> DirtyTiles;
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 TilesX = 0;
+	int32 TilesY = 0;
+	int32 FramesSinceKeyframe = 0;
+	float LastDirtyFraction = 1.0f;
+};
+
+/**
+ * Receive side reference: rebuilds full BGRA frames from keyframes and delta envelopes.
+ * This is what a server accepting delta frames has to do before inference.
+ * Construct on the game thread (it resolves the ImageWrapper module).
+ */
+class ALAKAZAMPORTAL_API FAlakazamDeltaCompositor
+{
+public:
+	FAlakazamDeltaCompositor();
+
+	/** Apply a keyframe JPEG or a delta envelope. Returns false if it could not be applied. */
+	bool Apply(const uint8* Data, int64 Size);
+
+	/** True once a keyframe has been applied */
+	bool HasFrame() const { return Width > 0; }
+
+	const TArray<uint8>& GetFrame() const { return Frame; }
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+
+private:
+	bool Decode(const uint8* Data, int64 Size, TArray<uint8>& OutBGRA, int32 ExpectedWidth, int32 ExpectedHeight);
+
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+	TSharedPtr<IImageWrapper> ImageWrapper;
+	TArray<uint8> Frame;
+	TArray<uint8> RectPixels;
+	int32 Width = 0;
+	int32 Height = 0;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IWebSocket.h"
+#include "Tasks/Task.h"
+#include "AlakazamJpegEncoder.h"
+#include "AlakazamDeltaFrames.h"
+#include "AlakazamFrameHeader.h"
+#include "AlakazamFrameMailbox.h"
+#include <atomic>
+#include "AlakazamEncodePipeline.generated.h"
+
+/** Per-stage timing of the frame encode pipeline (rolling averages, milliseconds) */
+USTRUCT(BlueprintType)
+struct FAlakazamEncodeStats
+{
+	GENERATED_BODY()
+
+	/** Time a frame waited between being mapped and the start of encoding */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float QueueWaitMs = 0.0f;
+
+	/** Time spent compressing a frame */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float EncodeMs = 0.0f;
+
+	/** Time spent handing the compressed frame to the socket on the game thread */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float SendMs = 0.0f;
+
+	/** Frames currently queued or being encoded */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	int32 QueueDepth = 0;
+
+	/** Frames dropped because the queue was full */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	int32 FramesDropped = 0;
+
+	/** Size of a sent frame in kilobytes */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float FrameKB = 0.0f;
+
+	/** Share of tiles that changed between frames, with delta frames enabled (0-1) */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float DirtyTileFraction = 0.0f;
+
+	/** Full frames sent while delta frames are enabled */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	int32 KeyframesSent = 0;
+};
+
+/** A frame handed to the socket */
+struct FAlakazamSentFrame
+{
+	uint32 Sequence = 0;
+	int64 Bytes = 0;
+	double EncodeDoneTime = 0.0;
+	double SendTime = 0.0;
+};
+
+/**
+ * A captured frame waiting to be encoded and sent.
+ * The source pixels are borrowed (typically locked readback memory) and must stay valid
+ * until OnSourceReleased is called from the worker thread.
+ */
+struct FAlakazamEncodeJob
+{
+	const uint8* SourceData = nullptr;
+	int32 SourcePitchBytes = 0;
+	TFunction<void()> OnSourceReleased;
+	int32 Width = 0;
+	int32 Height = 0;
+	int32 Quality = 85;
+	EAlakazamChromaSubsampling Subsampling = EAlakazamChromaSubsampling::Yuv420;
+	int32 NumStripes = 0;	// Parallel encode stripes, 0 = one per worker thread
+	bool bDeltaFrames = false;	// Send only changed tiles between keyframes
+	bool bForceKeyframe = false;
+	int32 KeyframeInterval = 60;
+	float MaxDirtyFraction = 0.5f;
+	bool bFrameHeader = false;	// Prefix the message with Header (negotiated with the server)
+	FAlakazamFrameHeader Header;
+	uint32 Sequence = 0;
+	double SubmitTime = 0.0;
+};
+
+/**
+ * Frame encode pipeline
+ *
+ * Compresses captured frames on worker threads, keeping JPEG encoding off the game thread,
+ * and hands the finished messages back to the game thread, which is the only thread that
+ * touches the socket. That keeps frames and prompt messages in the order they were issued.
+ * Jobs run in submission order and the number of frames in flight (queued, encoding or
+ * waiting to be sent) is bounded; Submit() refuses frames once the queue is full.
+ * Everything but the worker jobs runs on the game thread, and the owner must Flush() before
+ * releasing its reference (queued jobs keep the pipeline alive).
+ */
+class ALAKAZAMPORTAL_API FAlakazamEncodePipeline : public TSharedFromThis<FAlakazamEncodePipeline, ESPMode::ThreadSafe>
+{
+public:
+	FAlakazamEncodePipeline(TSharedPtr<IWebSocket> InWebSocket, int32 InMaxQueueDepth);
+
+	/** Queue a frame for encoding. Returns false (and drops the frame) if the queue is full. */
+	bool Submit(FAlakazamEncodeJob&& Job);
+
+	/** Block until every queued frame has been encoded, then send them */
+	void Flush();
+
+	/** Send the frames the workers have finished. Also scheduled on the game thread after each frame. */
+	void SendEncodedFrames();
+
+	/** Move the frames sent since the last call into OutFrames (appended, oldest first) */
+	void ConsumeSentFrames(TArray<FAlakazamSentFrame>& OutFrames);
+
+	FAlakazamEncodeStats GetStats() const;
+
+private:
+	static constexpr uint32 MaxFramesQueued = 8;	// Upper bound of the queue depth
+
+	/** A message ready for the socket, travelling from the worker to the game thread */
+	struct FEncodedFrame
+	{
+		TArray64<uint8> Message;
+		uint32 Sequence = 0;
+		double EncodeDoneTime = 0.0;
+	};
+
+	void RunJob(FAlakazamEncodeJob& Job);
+
+	TSharedPtr<IWebSocket> WebSocket;
+	int32 MaxQueueDepth;
+
+	// Jobs run one at a time, so one encoder and its buffers are reused for every frame
+	FAlakazamJpegEncoder Encoder;
+	FAlakazamPlanarImage Planes;
+	FAlakazamDeltaEncoder DeltaEncoder;
+	TArray64<uint8> CompressedData;
+
+	// Encoded messages go to the game thread, and their emptied buffers come back for reuse
+	TAlakazamSpscQueue<FEncodedFrame, MaxFramesQueued> EncodedFrames;
+	TAlakazamSpscQueue<TArray64<uint8>, MaxFramesQueued> FreeBuffers;
+
+	// Set by the game thread when a frame could not be sent, so the next delta starts from a keyframe
+	std::atomic<bool> bResetDelta{false};
+
+	UE::Tasks::FTask LastTask;
+
+	std::atomic<int32> QueueDepth{0};
+	std::atomic<int32> FramesDropped{0};
+
+	TArray<FAlakazamSentFrame> SentFrames;	// Game thread only
+
+	mutable FCriticalSection StatsLock;
+	FAlakazamEncodeStats Stats;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Binary frame header
+ *
+ * Once the server agrees to it in the auth/ready handshake ("frame_header": version), every
+ * binary frame message in either direction starts with this header, followed by the payload:
+ * a JPEG or delta envelope from the client, a JPEG or PNG from the server. The server echoes
+ * the header of the frame it stylized and fills in InferenceMs.
+ *
+ * Layout, all fields little endian:
+ *
+ *   0   uint8[4]  Magic "AKFH"
+ *   4   uint8     Version
+ *   5   uint8     Flags, reserved (0)
+ *   6   uint16    HeaderSize: bytes before the payload, so later versions can append fields
+ *   8   uint32    Sequence
+ *   12  uint32    PromptEpoch: bumped on every prompt or style change
+ *   16  uint64    CaptureTimeUs: client clock, only meaningful to the client
+ *   24  float[3]  CameraLocation (cm)
+ *   36  float[3]  CameraRotation (pitch, yaw, roll in degrees)
+ *   48  float     CameraFOV (degrees)
+ *   52  float     InferenceMs, filled in by the server
+ */
+struct ALAKAZAMPORTAL_API FAlakazamFrameHeader
+{
+	static constexpr uint8 CurrentVersion = 1;
+	static constexpr int32 EncodedSize = 56;
+
+	uint32 Sequence = 0;
+	uint32 PromptEpoch = 0;
+	uint64 CaptureTimeUs = 0;
+	FVector3f CameraLocation = FVector3f::ZeroVector;
+	FRotator3f CameraRotation = FRotator3f::ZeroRotator;
+	float CameraFOV = 0.0f;
+	float InferenceMs = 0.0f;
+
+	/** Append the encoded header to Out */
+	void Write(TArray64<uint8>& Out) const;
+
+	/** Parse a header at the start of Data. Returns the payload offset, or 0 if Data has no valid header. */
+	static int64 Read(const uint8* Data, int64 Size, FAlakazamFrameHeader& OutHeader);
+
+	/** Header timestamps are FPlatformTime seconds in microseconds */
+	static uint64 ToTimestampUs(double Seconds) { return static_cast<uint64>(FMath::Max(0.0, Seconds) * 1000000.0); }
+	static double FromTimestampUs(uint64 TimestampUs) { return TimestampUs / 1000000.0; }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Lock-free single-producer/single-consumer queue with a fixed capacity.
+ * Push() and Pop() never block; Push() fails when the queue is full.
+ * Items are moved in and out, so ownership of whatever they reference travels with them.
+ */
+template<typename ItemType, uint32 Capacity>
+class TAlakazamSpscQueue
+{
+public:
+	/** Producer side. Returns false if the queue is full. */
+	bool Push(ItemType&& Item)
+	{
+		const uint32 CurrentTail = Tail.load(std::memory_order_relaxed);
+		if (CurrentTail - Head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		Items[CurrentTail % Capacity] = MoveTemp(Item);
+		Tail.store(CurrentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Consumer side. Returns false if the queue is empty. */
+	bool Pop(ItemType& OutItem)
+	{
+		const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+		if (CurrentHead == Tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		OutItem = MoveTemp(Items[CurrentHead % Capacity]);
+		Head.store(CurrentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	ItemType Items[Capacity];
+	std::atomic<uint32> Head{0};
+	std::atomic<uint32> Tail{0};
+};
+
+/**
+ * Lock-free single-producer/single-consumer latest-wins mailbox (triple buffer).
+ * Publishing over an item the consumer has not taken yet hands that item back to the
+ * producer, which stays responsible for releasing whatever it owns.
+ */
+template<typename ItemType>
+class TAlakazamLatestMailbox
+{
+public:
+	/** Producer side. Returns true and fills OutEvicted if an unread item was overwritten. */
+	bool Publish(ItemType&& Item, ItemType& OutEvicted)
+	{
+		Buffers[Back] = MoveTemp(Item);
+		const uint8 Previous = Middle.exchange(Back | FreshBit, std::memory_order_acq_rel);
+		Back = Previous & ~FreshBit;
+
+		if (Previous & FreshBit)
+		{
+			OutEvicted = MoveTemp(Buffers[Back]);
+			return true;
+		}
+		return false;
+	}
+
+	/** Consumer side. Returns false if nothing new was published since the last call. */
+	bool Consume(ItemType& OutItem)
+	{
+		if (!(Middle.load(std::memory_order_relaxed) & FreshBit))
+		{
+			return false;
+		}
+
+		const uint8 Previous = Middle.exchange(Front, std::memory_order_acq_rel);
+		Front = Previous & ~FreshBit;
+		OutItem = MoveTemp(Buffers[Front]);
+		return true;
+	}
+
+private:
+	static constexpr uint8 FreshBit = 0x4;
+
+	ItemType Buffers[3];
+	std::atomic<uint8> Middle{1};	// Shared buffer index, FreshBit set while it holds an unread item
+	uint8 Back = 0;					// Producer-owned
+	uint8 Front = 2;				// Consumer-owned
+};
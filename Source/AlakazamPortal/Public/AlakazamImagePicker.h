@@ -2,8 +2,24 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "Engine/AssetUserData.h"
+#include "HAL/ThreadSafeBool.h"
 #include "AlakazamImagePicker.generated.h"
 
+/**
+ * The original JPEG/PNG file of an image loaded with LoadImageFromFile, attached to the texture.
+ * Style extraction sends these bytes as-is; the texture itself is then only used for preview.
+ */
+UCLASS()
+class ALAKAZAMPORTAL_API UAlakazamSourceImageData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	TArray<uint8> FileData;
+};
+
 /**
  * Blueprint Function Library for Alakazam image picking functionality.
  * Provides file browser and image loading utilities.
@@ -33,6 +49,7 @@ public:
 
 	/**
 	 * Load an image file from disk as a Texture2D.
+	 * Reasonably sized JPEG and PNG files keep their original bytes (UAlakazamSourceImageData) for style extraction.
 	 * @param FilePath Full path to the image file
 	 * @return The loaded texture, or nullptr if loading failed
 	 */
@@ -41,9 +58,9 @@ public:
 
 	/**
 	 * Load an image and send it to the Alakazam controller for style extraction.
-	 * Combines OpenImageFileDialog, LoadImageFromFile, and SetStyleFromImage.
+	 * Combines OpenImageFileDialog, LoadImageFromFileAsync, and SetStyleFromImage.
 	 * @param Controller The Alakazam controller to send the image to
-	 * @return True if image was selected and sent successfully
+	 * @return True if an image was selected; it is sent once it has loaded
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Alakazam|Image")
 	static bool BrowseAndApplyStyleImage(class UAlakazamController* Controller);
@@ -63,3 +80,52 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Alakazam|Image")
 	static TArray<FString> GetSupportedImageExtensions();
 };
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAlakazamImageLoaded, UTexture2D*, Texture);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAlakazamImageLoadedNative, UTexture2D* /*Texture*/);
+
+/**
+ * Non-blocking LoadImageFromFile: the file is read and decoded on a worker thread, and the
+ * texture is created on the game thread when done. C++ callers bind OnCompleteNative and call
+ * Activate() themselves; Cancel() discards a load still in progress.
+ */
+UCLASS()
+class ALAKAZAMPORTAL_API UAlakazamLoadImageAsync : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Load an image file from disk as a Texture2D without blocking.
+	 * @param Owner The result is discarded if this object is destroyed before the load finishes
+	 * @param FilePath Full path to the image file
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Alakazam|Image", meta = (BlueprintInternalUseOnly = "true", DefaultToSelf = "Owner"))
+	static UAlakazamLoadImageAsync* LoadImageFromFileAsync(UObject* Owner, const FString& FilePath);
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAlakazamImageLoaded OnLoaded;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAlakazamImageLoaded OnFailed;
+
+	/** Broadcast after the Blueprint events with the texture, or nullptr if loading failed */
+	FOnAlakazamImageLoadedNative OnCompleteNative;
+
+	virtual void Activate() override;
+
+	/** Stop listening; nothing is broadcast for a cancelled load */
+	UFUNCTION(BlueprintCallable, Category = "Alakazam|Image")
+	void Cancel();
+
+	bool IsLoading() const { return CancelFlag.IsValid(); }
+
+private:
+	void Complete(UTexture2D* Texture);
+
+	TWeakObjectPtr<UObject> Owner;
+	FString FilePath;
+
+	// Shared with the worker task while the load is in progress
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+};
@@ -9,6 +9,7 @@
 #include "AlakazamImagePickerWidget.generated.h"
 
 class UAlakazamController;
+class UAlakazamLoadImageAsync;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnImageSelected, UTexture2D*, SelectedImage);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStyleApplied, const FString&, ExtractedPrompt);
@@ -47,7 +48,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Alakazam")
 	void ClearImage();
 
-	/** Load an image from a file path */
+	/** Load an image from a file path. Loads in the background; OnImageSelected fires when it is ready. */
 	UFUNCTION(BlueprintCallable, Category = "Alakazam")
 	void LoadImageFromPath(const FString& FilePath);
 
@@ -95,6 +96,13 @@ private:
 	FString LoadedFilePath;
 	bool bIsDraggingOver;
 
+	// Image still loading; cancelled if the widget goes away first
+	UPROPERTY()
+	UAlakazamLoadImageAsync* PendingLoad = nullptr;
+	FString PendingFilePath;
+
+	void HandleImageLoaded(UTexture2D* Texture);
+
 	void UpdateUI();
 	void SetStatusText(const FString& Text);
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Binary image_prompt message
+ *
+ * Once the server agrees to it in the auth/ready handshake ("image_prompt_binary": version),
+ * reference images for style extraction are sent as a binary message instead of base64 in
+ * the JSON image_prompt. The image bytes (JPEG or PNG) follow a small header:
+ *
+ *   0   uint8[4]  Magic "AKIP"
+ *   4   uint8     Version
+ *   5   uint8     Flags: bit 0 = enhance prompt
+ *   6   uint16    HeaderSize: bytes before the image, so later versions can append fields
+ *   8   uint32    PromptEpoch
+ *   12  uint32    ImageSize
+ *
+ * All fields little endian.
+ */
+namespace AlakazamImagePrompt
+{
+	constexpr uint8 CurrentVersion = 1;
+	constexpr int32 HeaderSize = 16;
+	constexpr uint8 FlagEnhance = 0x1;
+
+	/** Largest image accepted, in either message form; far above any sane reference image and well inside ImageSize */
+	constexpr int64 MaxImageSize = 64 * 1024 * 1024;
+
+	/** Build the message for an encoded image into Out (replacing its contents). Fails for empty images or ones over MaxImageSize. */
+	ALAKAZAMPORTAL_API bool Write(const uint8* Image, int64 ImageSize, uint32 PromptEpoch, bool bEnhance, TArray64<uint8>& Out);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AlakazamColorConvert.h"
+
+/**
+ * Area-averaging (box filter) downscale of 4-channel 8-bit images, for shrinking reference
+ * images before they are encoded. Every destination pixel is the coverage-weighted mean of the
+ * source pixels under it, so arbitrary ratios stay alias free. Rows are accumulated in float
+ * with SSE2 or NEON (scalar elsewhere) and split into bands across the worker threads.
+ */
+namespace AlakazamImageResize
+{
+	/** Size with the longer edge at most MaxEdge, keeping the aspect ratio. Unchanged if it already fits or MaxEdge <= 0. */
+	ALAKAZAMPORTAL_API FIntPoint FitWithin(int32 Width, int32 Height, int32 MaxEdge);
+
+	/**
+	 * Downscale Source to DstWidth x DstHeight, written tightly packed to OutPixels in the
+	 * source's channel order. The destination must not be larger than the source on either axis.
+	 */
+	ALAKAZAMPORTAL_API bool Downscale(const FAlakazamPixelView& Source, int32 DstWidth, int32 DstHeight, TArray<uint8>& OutPixels);
+}
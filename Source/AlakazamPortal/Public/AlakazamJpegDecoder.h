@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IImageWrapper;
+class IImageWrapperModule;
+
+/**
+ * Restart-marker-aware JPEG decoder for received frames.
+ *
+ * When a baseline JPEG has a restart interval covering whole MCU rows, its entropy-coded data
+ * is cut at the RSTn markers into horizontal stripes. Each stripe is rewrapped as a small
+ * standalone JPEG (same tables, patched height, renumbered markers) and decoded on its own
+ * worker thread into its rows of the output. Frames without a usable restart layout are
+ * left to the caller's regular single-threaded path.
+ *
+ * Output matches a whole-image decode, except that with 4:2:0 chroma the two pixel rows
+ * at a stripe edge get replicated instead of interpolated chroma.
+ *
+ * Construct on the game thread (it resolves the ImageWrapper module). Decode() may then be
+ * called from any thread, one call at a time; stripe buffers and wrappers are reused.
+ */
+class ALAKAZAMPORTAL_API FAlakazamJpegDecoder
+{
+public:
+	FAlakazamJpegDecoder();
+
+	/**
+	 * Decode to BGRA8 in parallel stripes. MaxStripes of 0 uses one per worker thread.
+	 * Returns false if the frame has no usable restart markers or a stripe failed to decode.
+	 */
+	bool Decode(const uint8* Data, int64 Size, TArray<uint8>& OutBGRA, int32& OutWidth, int32& OutHeight, int32 MaxStripes = 0);
+
+private:
+	/** Entropy-coded bytes between two restart markers */
+	struct FSegment
+	{
+		int64 Start = 0;
+		int64 End = 0;
+	};
+
+	struct FStripe
+	{
+		TSharedPtr<IImageWrapper> Wrapper;
+		TArray<uint8> Jpeg;		// Standalone JPEG covering this stripe
+		TArray<uint8> Raw;
+		int32 FirstRow = 0;
+		int32 NumRows = 0;
+		bool bDecoded = false;
+	};
+
+	IImageWrapperModule* ImageWrapperModule = nullptr;
+	TArray<FSegment> Segments;
+	TArray<FStripe> Stripes;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AlakazamColorConvert.h"
+#include "AlakazamJpegEncoder.generated.h"
+
+/** Chroma subsampling of encoded JPEGs */
+UENUM(BlueprintType)
+enum class EAlakazamChromaSubsampling : uint8
+{
+	Yuv444 UMETA(DisplayName = "4:4:4 (best colour)"),
+	Yuv422 UMETA(DisplayName = "4:2:2"),
+	Yuv420 UMETA(DisplayName = "4:2:0 (smallest)")
+};
+
+/**
+ * Baseline JPEG encoder working from pre-converted planar YUV.
+ *
+ * Colour conversion is done by the SIMD kernels in AlakazamColorConvert instead of inside
+ * the encoder, and quantisation and Huffman state is kept between frames. Keep one instance
+ * per thread and reuse it: its conversion planes and the output array keep their memory,
+ * so steady-state encoding does not allocate.
+ *
+ * Large frames can be split into horizontal stripes of whole MCU rows that are encoded in
+ * parallel. Stripes are joined with restart markers (DRI/RSTn), so the result is still a
+ * single baseline JPEG any decoder reads.
+ */
+class ALAKAZAMPORTAL_API FAlakazamJpegEncoder
+{
+public:
+	FAlakazamJpegEncoder();
+
+	/**
+	 * Convert 4-channel pixels and encode them. OutJpeg is overwritten.
+	 * NumStripes: 1 encodes on the calling thread, 0 picks one stripe per worker thread.
+	 */
+	bool Encode(const FAlakazamPixelView& Pixels, int32 Quality, EAlakazamChromaSubsampling Subsampling, TArray64<uint8>& OutJpeg, int32 NumStripes = 1);
+
+	/** Encode already converted planes (Luma, YUV444, YUV422 or YUV420). OutJpeg is overwritten. */
+	bool EncodePlanar(const FAlakazamPlanarImage& Image, int32 Quality, TArray64<uint8>& OutJpeg, int32 NumStripes = 1);
+
+	static EAlakazamPixelLayout GetPlanarLayout(EAlakazamChromaSubsampling Subsampling);
+
+	/** Stripe count used for NumStripes = 0 */
+	static int32 GetAutoStripeCount();
+
+private:
+	/** Geometry of the MCU grid for one image */
+	struct FFrameLayout
+	{
+		int32 NumComponents = 0;
+		int32 MaxH = 1;
+		int32 MaxV = 1;
+		int32 McusX = 0;
+		int32 McusY = 0;
+	};
+
+	void UpdateQuantTables(int32 Quality);
+	FFrameLayout GetFrameLayout(const FAlakazamPlanarImage& Image) const;
+	void WriteHeaders(const FAlakazamPlanarImage& Image, const FFrameLayout& Frame, int32 RestartInterval, TArray64<uint8>& Out) const;
+
+	/** Entropy code a run of MCU rows into Scratch (grown as needed). Returns the number of bytes written. */
+	int64 EncodeMcuRows(const FAlakazamPlanarImage& Image, const FFrameLayout& Frame, int32 FirstMcuRow, int32 NumMcuRows, TArray64<uint8>& Scratch) const;
+
+	// Conversion target and entropy-coded data of each stripe, reused between frames
+	FAlakazamPlanarImage Planes;
+	TArray<TArray64<uint8>> StripeScratch;
+	TArray<int64> StripeBytes;
+
+	// Quantisation state for CachedQuality: DQT tables in zigzag order,
+	// and the matching float divisors (with the AAN DCT scale folded in) in natural order
+	int32 CachedQuality = -1;
+	uint8 QuantTables[2][64];
+	float Divisors[2][64];
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AlakazamLatencyTracker.generated.h"
+
+struct FAlakazamSentFrame;
+
+/** Latency percentiles of one pipeline stage, in milliseconds */
+USTRUCT(BlueprintType)
+struct FAlakazamLatencyPercentiles
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float P50Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float P95Ms = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	float P99Ms = 0.0f;
+};
+
+/**
+ * Per-stage latency of streamed frames over the recent window.
+ * Stages that pair a reply with the frame it answers (ServerRoundTrip, Total) need frame headers.
+ */
+USTRUCT(BlueprintType)
+struct FAlakazamLatencyStats
+{
+	GENERATED_BODY()
+
+	/** Capture issued to GPU readback ready */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Readback;
+
+	/** Readback ready to staging memory mapped on the render thread */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Copy;
+
+	/** Mapped to encoded, including the wait in the encode queue */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Encode;
+
+	/** Encoded to handed to the socket */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Send;
+
+	/** Handed to the socket to first byte of the reply: network both ways plus the server */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles ServerRoundTrip;
+
+	/** First byte of the reply to decoded */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Decode;
+
+	/** Decoded to output texture updated */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Upload;
+
+	/** Capture issued to output texture updated */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles Total;
+
+	/** Prompt or style change to the first frame shown that was stylized with it */
+	UPROPERTY(BlueprintReadOnly, Category = "Alakazam")
+	FAlakazamLatencyPercentiles PromptSwitch;
+};
+
+/**
+ * Collects per-frame stage timestamps (FPlatformTime seconds) of the streaming pipeline and
+ * turns them into stage latencies: percentiles over a recent window for the live stats, and a
+ * histogram over the whole session for the summary written on disconnect. Game thread only.
+ */
+class ALAKAZAMPORTAL_API FAlakazamLatencyTracker
+{
+public:
+	enum class EStage : uint8
+	{
+		Readback,
+		Copy,
+		Encode,
+		Send,
+		ServerRoundTrip,
+		Decode,
+		Upload,
+		Total,
+		PromptSwitch,
+		Num
+	};
+
+	FAlakazamLatencyTracker();
+
+	void OnCaptureIssued(uint32 Sequence, double Time);
+	void OnReadbackReady(uint32 Sequence, double Time);
+	void OnMapped(uint32 Sequence, double Time);
+	void OnSent(const FAlakazamSentFrame& Frame);
+
+	/** A reply was shown. Sequence 0 means the reply can't be paired with its frame (no frame header). */
+	void OnReplyShown(uint32 Sequence, double FirstByteTime, double DecodedTime, double UploadedTime);
+
+	/** The prompt changed; frames captured from now on carry Epoch */
+	void OnPromptChanged(uint32 Epoch, double Time);
+
+	/** A reply captured under PromptEpoch was shown. Only the first one after a change is measured. */
+	void OnPromptShown(uint32 PromptEpoch, double Time);
+
+	/** Percentiles over the most recent frames */
+	FAlakazamLatencyStats GetStats() const;
+
+	bool HasSamples() const;
+
+	/** Write the session-wide summary as JSON to Saved/Profiling/Alakazam. Returns the file path, or empty on failure. */
+	FString WriteSessionSummary(const FString& SessionId, int32 FramesSent, int32 FramesReceived) const;
+
+	void Reset();
+
+private:
+	static constexpr int32 NumStages = static_cast<int32>(EStage::Num);
+	static constexpr int32 RecentSamples = 256;
+	static constexpr int32 HistogramBuckets = 2000;	// 1 ms each; the last one collects everything slower
+
+	/** Send side timestamps of a frame, until its reply arrives */
+	struct FFrameTimes
+	{
+		uint32 Sequence = 0;
+		double CaptureIssued = 0.0;
+		double ReadbackReady = 0.0;
+		double Mapped = 0.0;
+		double Sent = 0.0;
+	};
+
+	struct FStageSamples
+	{
+		TArray<float> Recent;	// Ring of the latest samples (ms)
+		int32 NextRecent = 0;
+		TArray<uint32> Histogram;
+		int64 Count = 0;
+		double SumMs = 0.0;
+		float MaxMs = 0.0f;
+	};
+
+	FFrameTimes* FindFrame(uint32 Sequence);
+	void AddSample(EStage Stage, double StartTime, double EndTime);
+	static float HistogramPercentile(const FStageSamples& Samples, float Fraction);
+
+	TArray<FFrameTimes> Frames;	// Indexed by sequence modulo its size
+	uint32 PendingPromptEpoch = 0;	// Latest prompt change not shown yet, 0 if none
+	double PromptChangeTime = 0.0;
+	FStageSamples Stages[NumStages];
+	double SessionStart = 0.0;
+};
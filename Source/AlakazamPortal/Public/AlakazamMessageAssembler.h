@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * WebSocket message reassembly
+ *
+ * A message that arrives in one piece is handed back straight from the socket's buffer.
+ * Fragments are collected in a buffer that is sized for the whole message on the first
+ * fragment and keeps its capacity from one message to the next, so steady-state receiving
+ * allocates nothing. Game thread only.
+ */
+class ALAKAZAMPORTAL_API FAlakazamMessageAssembler
+{
+public:
+	/** Make room for messages of this size up front */
+	void Reserve(int64 Bytes);
+
+	/**
+	 * Add what the socket delivered. Returns true once a message is complete; OutData and
+	 * OutSize then point at it until the next call.
+	 */
+	bool Add(const uint8* Data, int64 Size, int64 BytesRemaining, const uint8*& OutData, int64& OutSize);
+
+	/** Drop a partly received message, keeping the allocation */
+	void Reset();
+
+	/** Part of a message has arrived and the rest is still to come */
+	bool IsReceiving() const { return !bComplete && Buffer.Num() > 0; }
+
+	const uint8* GetBufferData() const { return Buffer.GetData(); }
+	int64 GetCapacity() const { return Buffer.Max(); }
+
+private:
+	TArray<uint8> Buffer;
+	bool bComplete = false;	// Buffer holds a message already handed out
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Prompt change coalescing
+ *
+ * The first change after a quiet spell goes out at once; a burst (a text box, a slider) only
+ * sends its latest prompt, at most once per window. The owner keeps the prompt itself and
+ * sends it when told to, or at GetFlushTime() while one is held back. Game thread only.
+ */
+class ALAKAZAMPORTAL_API FAlakazamPromptDebounce
+{
+public:
+	/** The prompt changed at Now. Returns true to send it now, false if it is held back. */
+	bool OnChange(double Now, double Window);
+
+	/** A prompt went out at Now; it supersedes one held back */
+	void OnSent(double Now);
+
+	/** Forget a held-back change, e.g. when the prompt was replaced some other way */
+	void Cancel() { bPending = false; }
+
+	void Reset();
+
+	bool IsPending() const { return bPending; }
+
+	/** When a held-back change is due */
+	double GetFlushTime(double Window) const { return LastSendTime + Window; }
+
+private:
+	double LastSendTime = 0.0;
+	bool bHasSent = false;
+	bool bPending = false;
+};
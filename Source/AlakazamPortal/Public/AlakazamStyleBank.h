@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "AlakazamStyleBank.generated.h"
+
+class UTexture2D;
+
+/** One preset style: a text prompt, or a reference image with the prompt extracted from it */
+USTRUCT(BlueprintType)
+struct FAlakazamStyleBankEntry
+{
+	GENERATED_BODY()
+
+	/** Name SwitchStyle selects the style by */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Alakazam")
+	FName Id;
+
+	/** Text prompt, enhanced by the server if the controller's bEnhancePrompt is set. Ignored when the style comes from an image. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Alakazam", meta = (MultiLine = "true"))
+	FString Prompt;
+
+	/** Optional reference image the style is extracted from */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Alakazam")
+	UTexture2D* ReferenceImage = nullptr;
+
+	/**
+	 * Prompt the server extracted from ReferenceImage, so no round trip is needed at runtime.
+	 * Required for image entries, which are skipped without it: imported textures are
+	 * GPU-compressed (BC1/BC7 and the like), so a packaged build can't read their pixels.
+	 * Extracting the image in the editor fills it in, using the texture's source art.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Alakazam", meta = (MultiLine = "true"))
+	FString ExtractedPrompt;
+};
+
+/**
+ * Named preset styles. A controller with a style bank registers every resolved style with the
+ * server when it connects, so SwitchStyle only has to send the style's ID.
+ */
+UCLASS(BlueprintType)
+class ALAKAZAMPORTAL_API UAlakazamStyleBank : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Alakazam", meta = (TitleProperty = "Id"))
+	TArray<FAlakazamStyleBankEntry> Styles;
+
+	const FAlakazamStyleBankEntry* FindStyle(FName Id) const;
+};
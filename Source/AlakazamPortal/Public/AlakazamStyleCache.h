@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * On-disk cache of prompts the server extracted from reference images, so a reference image
+ * that was already analysed does not need a connection and a round trip again. Entries are
+ * keyed by a hash of the image bytes plus the enhance flag, evicted least recently used first
+ * once the cache grows past its size cap, and kept in Saved/Alakazam/StyleCache.json. The
+ * index is read on first use and written when an entry is added; lookups only update the
+ * recency in memory, which is written by Flush at module shutdown. Game thread only.
+ */
+class ALAKAZAMPORTAL_API FAlakazamStyleCache
+{
+public:
+	static FAlakazamStyleCache& Get();
+
+	/** Cache kept in IndexPath instead of the project's saved directory */
+	explicit FAlakazamStyleCache(const FString& IndexPath);
+
+	/** Cache key of the encoded image bytes sent for extraction */
+	static FString MakeKey(const uint8* Data, int64 Size, bool bEnhance);
+
+	/** Look up the prompt extracted for Key, marking the entry as recently used */
+	bool Find(const FString& Key, FString& OutPrompt);
+
+	/** Remember a prompt, evicting the least recently used entries until the cache fits in MaxBytes */
+	void Add(const FString& Key, const FString& ExtractedPrompt, int64 MaxBytes);
+
+	/** Write recency changes made by lookups since the index was last saved */
+	void Flush();
+
+	void Clear();
+
+	int32 Num() const { return Entries.Num(); }
+	int64 GetTotalBytes() const { return TotalBytes; }
+
+private:
+	struct FEntry
+	{
+		FString Prompt;
+		uint64 LastUse = 0;
+	};
+
+	void Load();
+	void Save();
+	static int64 EntryBytes(const FString& Key, const FEntry& Entry);
+
+	FString Path;
+	TMap<FString, FEntry> Entries;
+	int64 TotalBytes = 0;
+	uint64 UseCounter = 0;	// Orders entries by recency; the file stores them oldest first
+	bool bLoaded = false;
+	bool bDirty = false;
+};